@@ -0,0 +1,612 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "flib.hpp"
+
+// fcol: compact binary column format for arrays of frac, fract or fracti
+//
+// layout (little endian):
+//   header   "FLIBCOL" 0, u8 version, u8 type, u16 0, u32 block size, u64 count, u64 index offset
+//   blocks   varint count, then one stream per field: num, den (frac), + power (fract), + pownum, powden (fracti)
+//   index    u64 offset of every block
+// a stream is varint byte length, mode byte, payload:
+//   FCOL_CONST   one zigzag varint shared by the whole block
+//   FCOL_RLE     varint run count, then (zigzag varint value, varint length) per run, for shared denominators
+//   FCOL_FOR     frame of reference: zigzag varint minimum, width byte, values - minimum bit packed at that width
+//   FCOL_VARINT  one zigzag varint per value
+// the writer picks the smallest mode for each stream of each block (exponent streams are separate and usually constant).
+// given a path the writer streams each block to the file as it fills and keeps only the block index in memory,
+// then appends the index and fills in the header on finish(), so columns larger than memory can be written.
+// fcolreader reads straight from memory (e.g. an fcolmap of the file) without copying it,
+// and the block index gives random access: get() only decodes the one value it needs (O(1) for const and frame of reference).
+// the writer stores values in simplified form, so the reader builds them with raw() and never runs simplify() again.
+
+#define FCOL_FRAC 1
+#define FCOL_FRACT 2
+#define FCOL_FRACTI 3
+
+#define FCOL_CONST 0
+#define FCOL_RLE 1
+#define FCOL_FOR 2
+#define FCOL_VARINT 3
+
+#define FCOL_HEADER_SIZE 32
+#define FCOL_DEFAULT_BLOCK 4096
+
+class fcolwriter {
+private:
+    uint8_t type;
+    uint32_t block;
+    uint64_t count;
+    bool finished;
+    bool ok;
+    std::vector<int32_t> fields[4];
+    std::vector<uint64_t> index;
+    std::vector<uint8_t> out; // the whole column in memory, or only the bytes not yet written to file
+    FILE* file;
+    uint64_t written; // bytes already written to file
+
+    static uint32_t zigzag(int32_t v) {
+        return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+    }
+
+    static void putVarint(std::vector<uint8_t>& b, uint64_t v) {
+        while (v >= 0x80) {
+            b.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        b.push_back((uint8_t)v);
+    }
+
+    static void putU64(std::vector<uint8_t>& b, size_t at, uint64_t v) {
+        memcpy(&b[at], &v, 8);
+    }
+
+    static std::vector<uint8_t> encodeConst(const std::vector<int32_t>& v) {
+        std::vector<uint8_t> b;
+        b.push_back(FCOL_CONST);
+        putVarint(b, zigzag(v[0]));
+        return b;
+    }
+
+    static std::vector<uint8_t> encodeRle(const std::vector<int32_t>& v) {
+        std::vector<uint8_t> runs;
+        uint64_t n = 0;
+        for (size_t i = 0; i < v.size();) {
+            size_t j = i;
+            while (j < v.size() && v[j] == v[i]) {
+                j++;
+            }
+            putVarint(runs, zigzag(v[i]));
+            putVarint(runs, j - i);
+            n++;
+            i = j;
+        }
+        std::vector<uint8_t> b;
+        b.push_back(FCOL_RLE);
+        putVarint(b, n);
+        b.insert(b.end(), runs.begin(), runs.end());
+        return b;
+    }
+
+    static std::vector<uint8_t> encodeFor(const std::vector<int32_t>& v) {
+        int32_t lo = v[0];
+        int32_t hi = v[0];
+        for (size_t i = 1; i < v.size(); i++) {
+            lo = v[i] < lo ? v[i] : lo;
+            hi = v[i] > hi ? v[i] : hi;
+        }
+        uint32_t range = (uint32_t)hi - (uint32_t)lo;
+        uint8_t w = 0;
+        while (w < 32 && (range >> w) != 0) {
+            w++;
+        }
+        std::vector<uint8_t> b;
+        b.push_back(FCOL_FOR);
+        putVarint(b, zigzag(lo));
+        b.push_back(w);
+        size_t start = b.size();
+        // 8 bytes of padding so readers can always load a whole 64-bit word
+        b.resize(start + (v.size() * w + 7) / 8 + 8, 0);
+        for (size_t i = 0; i < v.size(); i++) {
+            uint64_t x = (uint32_t)v[i] - (uint32_t)lo;
+            size_t bit = i * w;
+            for (uint8_t k = 0; k < w; k++, bit++) {
+                b[start + bit / 8] |= ((x >> k) & 1) << (bit % 8);
+            }
+        }
+        return b;
+    }
+
+    static std::vector<uint8_t> encodeVarint(const std::vector<int32_t>& v) {
+        std::vector<uint8_t> b;
+        b.push_back(FCOL_VARINT);
+        for (size_t i = 0; i < v.size(); i++) {
+            putVarint(b, zigzag(v[i]));
+        }
+        return b;
+    }
+
+    void putStream(const std::vector<int32_t>& v) {
+        std::vector<uint8_t> best;
+        bool same = true;
+        for (size_t i = 1; i < v.size() && same; i++) {
+            same = v[i] == v[0];
+        }
+        if (same) {
+            best = encodeConst(v);
+        } else {
+            best = encodeFor(v);
+            std::vector<uint8_t> b = encodeRle(v);
+            if (b.size() < best.size()) {
+                best = b;
+            }
+            b = encodeVarint(v);
+            if (b.size() < best.size()) {
+                best = b;
+            }
+        }
+        putVarint(out, best.size());
+        out.insert(out.end(), best.begin(), best.end());
+    }
+
+    // writes out the pending bytes when streaming to a file
+    void emit() {
+        if (file == NULL || out.empty()) {
+            return;
+        }
+        ok = fwrite(out.data(), 1, out.size(), file) == out.size() && ok;
+        written += out.size();
+        out.clear();
+    }
+
+    void flush() {
+        if (fields[0].empty()) {
+            return;
+        }
+        index.push_back(written + out.size());
+        putVarint(out, fields[0].size());
+        for (int32_t f = 0; f < fieldCount(); f++) {
+            putStream(fields[f]);
+            fields[f].clear();
+        }
+        emit();
+    }
+
+    void header(uint8_t* h, uint64_t at) {
+        memset(h, 0, FCOL_HEADER_SIZE);
+        memcpy(h, "FLIBCOL", 8);
+        h[8] = 1;
+        h[9] = type;
+        memcpy(h + 12, &block, 4);
+        memcpy(h + 16, &count, 8);
+        memcpy(h + 24, &at, 8);
+    }
+
+    int32_t fieldCount() {
+        return type == FCOL_FRAC ? 2 : (type == FCOL_FRACT ? 3 : 4);
+    }
+
+    void add(int32_t n, int32_t d, int32_t p1, int32_t p2) {
+        fields[0].push_back(n);
+        fields[1].push_back(d);
+        // only the streams this column type has, the rest would never be flushed
+        if (type != FCOL_FRAC) {
+            fields[2].push_back(p1);
+        }
+        if (type == FCOL_FRACTI) {
+            fields[3].push_back(p2);
+        }
+        count++;
+        if (fields[0].size() == block) {
+            flush();
+        }
+    }
+
+    bool check(uint8_t t) {
+        if (finished) {
+            printf("Warning: column already finished, value ignored.\n");
+            return false;
+        }
+        if (t != type) {
+            printf("Warning: value does not match the column type, ignored.\n");
+            return false;
+        }
+        return true;
+    }
+
+public:
+    // builds the column in memory, see bytes() and save()
+    fcolwriter(uint8_t t, uint32_t blockSize) {
+        type = t;
+        block = blockSize == 0 ? FCOL_DEFAULT_BLOCK : blockSize;
+        count = 0;
+        finished = false;
+        ok = true;
+        file = NULL;
+        written = 0;
+        out.resize(FCOL_HEADER_SIZE, 0);
+    }
+    fcolwriter(uint8_t t) : fcolwriter(t, FCOL_DEFAULT_BLOCK) {
+    }
+    // streams the column to a file, which is complete once finish() returns true
+    fcolwriter(const char* path, uint8_t t, uint32_t blockSize) : fcolwriter(t, blockSize) {
+        file = fopen(path, "wb");
+        if (file == NULL) {
+            printf("Warning: could not open \"%s\" for writing.\n", path);
+            ok = false;
+            return;
+        }
+        emit();
+    }
+    fcolwriter(const char* path, uint8_t t) : fcolwriter(path, t, FCOL_DEFAULT_BLOCK) {
+    }
+    ~fcolwriter() {
+        if (file != NULL) {
+            finish();
+        }
+    }
+    fcolwriter(const fcolwriter&) = delete;
+    fcolwriter& operator=(const fcolwriter&) = delete;
+
+    void add(frac f) {
+        if (check(FCOL_FRAC)) {
+            add(f.getNum(), f.getDen(), 0, 0);
+        }
+    }
+    void add(fract f) {
+        if (check(FCOL_FRACT)) {
+            add(f.getNum(), f.getDen(), f.getPower(), 0);
+        }
+    }
+    void add(fracti f) {
+        if (check(FCOL_FRACTI)) {
+            add(f.getNum(), f.getDen(), f.getPowNum(), f.getPowDen());
+        }
+    }
+
+    // flushes the last block, appends the index and fills in the header (closing the file when streaming),
+    // false if writing failed. no values can be added after this
+    bool finish() {
+        if (finished) {
+            return ok;
+        }
+        finished = true;
+        flush();
+        uint64_t at = written + out.size();
+        size_t start = out.size();
+        out.resize(start + index.size() * 8);
+        for (size_t i = 0; i < index.size(); i++) {
+            putU64(out, start + i * 8, index[i]);
+        }
+        if (file == NULL) {
+            header(&out[0], at);
+            return ok;
+        }
+        emit();
+        uint8_t h[FCOL_HEADER_SIZE];
+        header(h, at);
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(h, 1, FCOL_HEADER_SIZE, file) == FCOL_HEADER_SIZE && ok;
+        ok = fclose(file) == 0 && ok;
+        file = NULL;
+        return ok;
+    }
+
+    // the encoded column of a writer built in memory
+    const std::vector<uint8_t>& bytes() {
+        finish();
+        return out;
+    }
+
+    bool save(const char* path) {
+        if (!finish() || written != 0) {
+            return false;
+        }
+        FILE* f = fopen(path, "wb");
+        if (f == NULL) {
+            return false;
+        }
+        bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+        return fclose(f) == 0 && ok;
+    }
+};
+
+class fcolreader {
+private:
+    const uint8_t* data;
+    size_t size;
+    uint8_t type;
+    uint32_t block;
+    uint64_t count;
+    const uint8_t* index;
+    uint64_t blocks;
+
+    // streams of the last block looked up
+    uint64_t cached;
+    uint32_t cachedCount;
+    const uint8_t* streams[4];
+    const uint8_t* streamEnds[4];
+
+    static int32_t unzigzag(uint32_t v) {
+        return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+    }
+
+    // reads a varint from [p, end), NULL if it runs off the end
+    static const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint64_t& v) {
+        v = 0;
+        for (int32_t shift = 0; p < end && shift < 64; shift += 7) {
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                return p;
+            }
+        }
+        return NULL;
+    }
+
+    static uint64_t getU64(const uint8_t* p) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        return v;
+    }
+
+    int32_t fieldCount() {
+        return type == FCOL_FRAC ? 2 : (type == FCOL_FRACT ? 3 : 4);
+    }
+
+    bool locate(uint64_t b) {
+        if (b == cached) {
+            return true;
+        }
+        uint64_t off = getU64(index + b * 8);
+        const uint8_t* end = index;
+        if (off < FCOL_HEADER_SIZE || off >= (uint64_t)(index - data)) {
+            return false;
+        }
+        uint64_t n;
+        const uint8_t* p = getVarint(data + off, end, n);
+        uint64_t expect = count - b * block < block ? count - b * block : block;
+        if (p == NULL || n != expect) {
+            return false;
+        }
+        for (int32_t f = 0; f < fieldCount(); f++) {
+            uint64_t len;
+            p = getVarint(p, end, len);
+            if (p == NULL || len == 0 || len > (uint64_t)(end - p)) {
+                return false;
+            }
+            streams[f] = p;
+            streamEnds[f] = p + len;
+            p += len;
+        }
+        cached = b;
+        cachedCount = n;
+        return true;
+    }
+
+    // value i of a stream
+    static int32_t value(const uint8_t* s, const uint8_t* end, uint32_t i) {
+        uint8_t mode = *s++;
+        uint64_t v, n;
+        switch (mode) {
+            case FCOL_CONST:
+                getVarint(s, end, v);
+                return unzigzag(v);
+            case FCOL_RLE:
+                s = getVarint(s, end, n);
+                for (uint64_t r = 0; r < n && s != NULL; r++) {
+                    s = getVarint(s, end, v);
+                    uint64_t len;
+                    s = s == NULL ? NULL : getVarint(s, end, len);
+                    if (i < len) {
+                        return unzigzag(v);
+                    }
+                    i -= len;
+                }
+                return 0;
+            case FCOL_FOR: {
+                s = getVarint(s, end, v);
+                if (s == NULL || s >= end) {
+                    return 0;
+                }
+                uint8_t w = *s++;
+                uint64_t bit = (uint64_t)i * w;
+                if (w > 32 || bit / 8 + 8 > (uint64_t)(end - s)) {
+                    return 0;
+                }
+                uint64_t word;
+                memcpy(&word, s + bit / 8, 8);
+                uint64_t mask = w == 0 ? 0 : (~(uint64_t)0 >> (64 - w));
+                return (int32_t)((uint32_t)unzigzag(v) + (uint32_t)((word >> (bit % 8)) & mask));
+            }
+            case FCOL_VARINT:
+                for (uint32_t k = 0; s != NULL && k < i; k++) {
+                    s = getVarint(s, end, v);
+                }
+                if (s == NULL || getVarint(s, end, v) == NULL) {
+                    return 0;
+                }
+                return unzigzag(v);
+        }
+        return 0;
+    }
+
+    // all n values of a stream
+    static void values(const uint8_t* s, const uint8_t* end, uint32_t n, int32_t* out) {
+        uint8_t mode = *s;
+        if (mode == FCOL_FOR || mode == FCOL_CONST) {
+            for (uint32_t i = 0; i < n; i++) {
+                out[i] = value(s, end, i);
+            }
+            return;
+        }
+        s++;
+        uint64_t v, len, runs;
+        uint32_t i = 0;
+        if (mode == FCOL_RLE) {
+            s = getVarint(s, end, runs);
+            for (uint64_t r = 0; r < runs && s != NULL; r++) {
+                s = getVarint(s, end, v);
+                s = s == NULL ? NULL : getVarint(s, end, len);
+                for (uint64_t k = 0; s != NULL && k < len && i < n; k++) {
+                    out[i++] = unzigzag(v);
+                }
+            }
+        } else {
+            while (i < n && s != NULL) {
+                s = getVarint(s, end, v);
+                out[i++] = s == NULL ? 0 : unzigzag(v);
+            }
+        }
+        while (i < n) {
+            out[i++] = 0;
+        }
+    }
+
+    bool fields(uint64_t i, int32_t* f) {
+        if (i >= count || !locate(i / block)) {
+            printf("Warning: fcol index out of range or column corrupt.\n");
+            return false;
+        }
+        uint32_t j = i % block;
+        f[2] = f[3] = 0;
+        for (int32_t k = 0; k < fieldCount(); k++) {
+            f[k] = value(streams[k], streamEnds[k], j);
+        }
+        return true;
+    }
+
+    // decodes values [first, first + n) with fn(num, den, p1, p2, position), returns how many were decoded
+    template <typename F>
+    uint64_t decode(uint64_t first, uint64_t n, F fn) {
+        std::vector<int32_t> buf[4];
+        uint64_t done = 0;
+        while (done < n && first + done < count) {
+            uint64_t i = first + done;
+            if (!locate(i / block)) {
+                printf("Warning: fcol column corrupt.\n");
+                break;
+            }
+            for (int32_t k = 0; k < 4; k++) {
+                buf[k].assign(cachedCount, 0);
+                if (k < fieldCount()) {
+                    values(streams[k], streamEnds[k], cachedCount, buf[k].data());
+                }
+            }
+            for (uint32_t j = i % block; j < cachedCount && done < n; j++, done++) {
+                fn(buf[0][j], buf[1][j], buf[2][j], buf[3][j], done);
+            }
+        }
+        return done;
+    }
+
+public:
+    // data must stay valid (and mapped) for the lifetime of the reader
+    fcolreader(const void* d, size_t n) {
+        data = (const uint8_t*)d;
+        size = n;
+        type = 0;
+        block = 0;
+        count = 0;
+        index = NULL;
+        blocks = 0;
+        cached = UINT64_MAX;
+        cachedCount = 0;
+        if (size < FCOL_HEADER_SIZE || memcmp(data, "FLIBCOL", 8) != 0 || data[8] != 1) {
+            return;
+        }
+        uint32_t b;
+        memcpy(&b, data + 12, 4);
+        uint64_t c = getU64(data + 16);
+        uint64_t at = getU64(data + 24);
+        uint64_t nb = b == 0 ? 0 : (c + b - 1) / b;
+        if (b == 0 || data[9] < FCOL_FRAC || data[9] > FCOL_FRACTI || at < FCOL_HEADER_SIZE || at > size || (size - at) / 8 < nb) {
+            return;
+        }
+        type = data[9];
+        block = b;
+        count = c;
+        index = data + at;
+        blocks = nb;
+    }
+
+    bool valid() {
+        return type != 0;
+    }
+    uint8_t getType() {
+        return type;
+    }
+    uint64_t length() {
+        return count;
+    }
+
+    frac getFrac(uint64_t i) {
+        int32_t f[4];
+        return fields(i, f) ? frac::raw(f[0], f[1]) : frac();
+    }
+    fract getFract(uint64_t i) {
+        int32_t f[4];
+        return fields(i, f) ? fract::raw(f[0], f[1], f[2]) : fract();
+    }
+    fracti getFracti(uint64_t i) {
+        int32_t f[4];
+        return fields(i, f) ? fracti::raw(f[0], f[1], f[2], f[3]) : fracti();
+    }
+
+    // bulk reads of values [first, first + n) into out, return how many were read
+    uint64_t read(uint64_t first, uint64_t n, frac* out) {
+        return decode(first, n, [&](int32_t a, int32_t b, int32_t, int32_t, uint64_t k) { out[k] = frac::raw(a, b); });
+    }
+    uint64_t read(uint64_t first, uint64_t n, fract* out) {
+        return decode(first, n, [&](int32_t a, int32_t b, int32_t p, int32_t, uint64_t k) { out[k] = fract::raw(a, b, p); });
+    }
+    uint64_t read(uint64_t first, uint64_t n, fracti* out) {
+        return decode(first, n, [&](int32_t a, int32_t b, int32_t p, int32_t q, uint64_t k) { out[k] = fracti::raw(a, b, p, q); });
+    }
+};
+
+// read only memory map of a column file (POSIX)
+class fcolmap {
+private:
+    void* data;
+    size_t size;
+
+public:
+    fcolmap(const char* path) {
+        data = NULL;
+        size = 0;
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data = p;
+                size = st.st_size;
+            }
+        }
+        close(fd);
+    }
+    ~fcolmap() {
+        if (data != NULL) {
+            munmap(data, size);
+        }
+    }
+    fcolmap(const fcolmap&) = delete;
+    fcolmap& operator=(const fcolmap&) = delete;
+
+    bool valid() {
+        return data != NULL;
+    }
+    fcolreader reader() {
+        return fcolreader(data, size);
+    }
+};
@@ -0,0 +1,232 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include "flib.hpp"
+#include "pow10.hpp"
+#include "int128.hpp"
+
+// fixed_den<D> {n} = n / D
+// the denominator is a compile time constant (100 for cents, 64 for 1/64ths, ticks per second, ...),
+// so only the numerator is stored and nothing is ever simplified:
+// + - and comparisons are plain integer ops, * and / rescale by D, which the compiler turns into a multiply and shift.
+// * and / round to the nearest multiple of 1/D (halves away from zero), everything else is exact.
+// converting to frac or fract is always exact, converting from them is exact when their denominator divides D
+// (exactly() checks), otherwise the value is rounded to the nearest multiple of 1/D.
+// results whose numerator does not fit in 32 bits print a warning and give 0, like the other types.
+
+template <int32_t D>
+class fixed_den {
+    static_assert(D > 0, "fixed_den: denominator must be positive");
+
+private:
+    int32_t num; // numerator, the value is num / D
+
+    // n / d rounded to the nearest integer, halves away from zero, d > 0
+    static int64_t divRound(int64_t n, int64_t d) {
+        int64_t q = n / d;
+        int64_t r = n % d;
+        if (2 * (r < 0 ? -r : r) >= d) {
+            q += n < 0 ? -1 : 1;
+        }
+        return q;
+    }
+
+    // v as a numerator, 0 with a warning if it does not fit
+    static int32_t narrow(int128_t v) {
+        if (v > INT32_MAX || v < -INT32_MAX) {
+            printf("Warning: fixed_den overflow.\n");
+            return 0;
+        }
+        return (int32_t)v;
+    }
+
+    // n / d as a multiple of 1/D, rounded
+    void set(int64_t n, int64_t d) {
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            num = 0;
+            return;
+        }
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        if (D % d == 0) {
+            num = narrow((int128_t)n * (D / d));
+            return;
+        }
+        // n * D / d rounded like divRound, in 128 bits since n can use all 64
+        int128_t v = (int128_t)n * D;
+        int128_t q = v / d;
+        int128_t r = v % d;
+        if (2 * (r < 0 ? -r : r) >= d) {
+            q += v < 0 ? -1 : 1;
+        }
+        num = narrow(q);
+    }
+
+    // fract f as n / d in lowest terms, false if that does not fit in 64 bits
+    static bool split(fract f, int64_t& n, int64_t& d) {
+        n = f.getNum();
+        d = f.getDen();
+        int32_t p = f.getPower();
+        if (!flib_scale10(p > 0 ? n : d, p > 0 ? p : -p)) {
+            return false;
+        }
+        int64_t a = n < 0 ? -n : n;
+        int64_t b = d;
+        int64_t c;
+        while (a != 0) {
+            c = a;
+            a = b % a;
+            b = c;
+        }
+        n /= b;
+        d /= b;
+        return true;
+    }
+
+public:
+    fixed_den(int32_t n, int32_t d) {
+        set(n, d);
+    }
+    fixed_den(int32_t n) {
+        num = narrow((int64_t)n * D);
+    }
+    fixed_den() {
+        num = 0;
+    }
+    fixed_den(float f) : fixed_den((double)f) {}
+    fixed_den(double d) {
+        double v = d * D + (d < 0 ? -0.5 : 0.5);
+        if (!(v < 2147483648.0 && v > -2147483648.0)) {
+            printf("Warning: fixed_den overflow.\n");
+            num = 0;
+            return;
+        }
+        num = (int32_t)v;
+    }
+    fixed_den(frac f) {
+        set(f.getNum(), f.getDen());
+    }
+    fixed_den(fract f) {
+        int64_t n, d;
+        if (split(f, n, d)) {
+            set(n, d);
+        } else if (f.getPower() < 0) {
+            num = 0; // below 10^-18 of the 32-bit numerator, rounds to 0
+        } else {
+            printf("Warning: fixed_den overflow.\n");
+            num = 0;
+        }
+    }
+
+    // the value with numerator n, i.e. n / D
+    static fixed_den raw(int32_t n) {
+        fixed_den r;
+        r.num = n;
+        return r;
+    }
+    // true if f converts without rounding
+    static bool exactly(frac f) {
+        return f.getDen() != 0 && D % f.getDen() == 0;
+    }
+    static bool exactly(fract f) {
+        int64_t n, d;
+        if (!split(f, n, d)) {
+            return f.getNum() == 0;
+        }
+        return d != 0 && D % d == 0;
+    }
+    int32_t getNum() {
+        return num;
+    }
+    int32_t getDen() {
+        return D;
+    }
+
+    fixed_den operator+(fixed_den f) {
+        return raw(narrow((int64_t)num + f.num));
+    }
+    fixed_den operator-(fixed_den f) {
+        return raw(narrow((int64_t)num - f.num));
+    }
+    fixed_den operator*(fixed_den f) {
+        return raw(narrow(divRound((int64_t)num * f.num, D)));
+    }
+    fixed_den operator/(fixed_den f) {
+        if (f.num == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            return fixed_den();
+        }
+        int64_t n = (int64_t)num * D;
+        return raw(narrow(f.num < 0 ? divRound(-n, -(int64_t)f.num) : divRound(n, f.num)));
+    }
+    fixed_den operator*(int32_t n) {
+        return raw(narrow((int64_t)num * n));
+    }
+    fixed_den operator+=(fixed_den f) {
+        *this = *this + f;
+        return *this;
+    }
+    fixed_den operator-=(fixed_den f) {
+        *this = *this - f;
+        return *this;
+    }
+    fixed_den operator*=(fixed_den f) {
+        *this = *this * f;
+        return *this;
+    }
+    fixed_den operator/=(fixed_den f) {
+        *this = *this / f;
+        return *this;
+    }
+    fixed_den operator-() {
+        return raw(-num);
+    }
+    fixed_den operator+() {
+        return *this;
+    }
+    bool operator==(fixed_den f) {
+        return num == f.num;
+    }
+    bool operator!=(fixed_den f) {
+        return num != f.num;
+    }
+    bool operator>(fixed_den f) {
+        return num > f.num;
+    }
+    bool operator<(fixed_den f) {
+        return num < f.num;
+    }
+    bool operator>=(fixed_den f) {
+        return num >= f.num;
+    }
+    bool operator<=(fixed_den f) {
+        return num <= f.num;
+    }
+
+    operator frac() {
+        return frac(num, D);
+    }
+    operator fract() {
+        return fract(num, D);
+    }
+    operator float() {
+        return (float)num / (float)D;
+    }
+    operator double() {
+        return (double)num / (double)D;
+    }
+    operator int32_t() {
+        return num / D;
+    }
+
+    void frcPrint() {
+        frac f = *this;
+        f.frcPrint();
+    }
+    void decPrint() {
+        printf("%f\n", (double)num / (double)D);
+    }
+};
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <cstdint>
 #include <cmath>
+#include "pow10.hpp"
 
 // fraction classes
 // frac {n, d} = n / d
@@ -60,6 +61,9 @@ public:
             a = b % a;
             b = c;
         }
+        if (b < 0) {
+            b = -b;
+        }
         num /= b;
         den /= b;
         return *this;
@@ -148,6 +152,19 @@ public:
     bool operator<=(frac f) {
         return num * f.den <= den * f.num;
     }
+    // n / d as is, for results that are already in lowest terms with d > 0
+    static frac raw(int32_t n, int32_t d) {
+        frac r;
+        r.num = n;
+        r.den = d;
+        return r;
+    }
+    int32_t getNum() {
+        return num;
+    }
+    int32_t getDen() {
+        return den;
+    }
     void frcPrint() {
         simplify();
         printf("%ld/%ld\n", num, den);
@@ -185,6 +202,12 @@ public:
         power = 0;
         simplify();
     }
+    fract(int32_t n, int32_t d, int8_t p) {
+        num = n;
+        den = d;
+        power = p;
+        simplify();
+    }
     fract(int32_t n) {
         num = n;
         den = 1;
@@ -214,80 +237,71 @@ public:
             printf("Warning: denominator is 0, answer is undefined.\n");
             return *this;
         }
-        if (den < 0) {
-            num *= -1;
-            den *= -1;
-        }
-        int32_t a = num;
-        int32_t b = den;
-        int32_t c;
-        while (a != 0) {
-            c = a;
-            a = b % a;
-            b = c;
+        set(num, den, power);
+        return *this;
+    }
+    // stores n / d * 10^p in lowest terms, with the factors of ten moved into the power
+    void set(int64_t n, int64_t d, int32_t p) {
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            num = n;
+            den = 0;
+            return;
         }
-        num /= b;
-        den /= b;
-        
-        while (den % 10 == 0) {
-            den /= 10;
-            power--;
+        flib_normalize10(n, d, p);
+        if (n > INT32_MAX || n < -INT32_MAX || d > INT32_MAX || p > INT8_MAX || p < INT8_MIN) {
+            printf("Warning: fract overflow.\n");
         }
-        while(num % 10 == 0 && num != 0) {
-            num /= 10;
-            power++;
+        num = n;
+        den = d;
+        power = p;
+    }
+    // a + sign * b, with the exponents aligned exactly
+    static fract sum(fract a, fract b, int32_t sign) {
+        fract r;
+        // a zero operand keeps the other's exponent, so it is never scaled
+        int32_t p = a.num == 0 ? b.power : (b.num == 0 ? a.power : (a.power < b.power ? a.power : b.power));
+        int64_t x = (int64_t)a.num * b.den;
+        int64_t y = (int64_t)b.num * a.den * sign;
+        int64_t n;
+        if (!flib_scale10(x, a.power - p) || !flib_scale10(y, b.power - p) || __builtin_add_overflow(x, y, &n)) {
+            printf("Warning: fract overflow.\n");
+            return r;
         }
-        return *this;
+        r.set(n, (int64_t)a.den * b.den, p);
+        return r;
     }
     fract operator+(fract f) {
-        fract r;
-        r.num = num * f.den + den * f.num;
-        r.den = den * f.den;
-        r.power = power;
-        return r.simplify();
+        return sum(*this, f, 1);
     }
     fract operator-(fract f) {
-        fract r;
-        r.num = num * f.den - den * f.num;
-        r.den = den * f.den;
-        r.power = power;
-        return r.simplify();
+        return sum(*this, f, -1);
     }
     fract operator*(fract f) {
         fract r;
-        r.num = num * f.num;
-        r.den = den * f.den;
-        r.power = power + f.power;
-        return r.simplify();
+        r.set((int64_t)num * f.num, (int64_t)den * f.den, power + f.power);
+        return r;
     }
     fract operator/(fract f) {
         fract r;
-        r.num = num * f.den;
-        r.den = den * f.num;
-        r.power = power - f.power;
-        return r.simplify();
+        r.set((int64_t)num * f.den, (int64_t)den * f.num, power - f.power);
+        return r;
     }
     fract operator+=(fract f) {
-        num = num * f.den + den * f.num;
-        den = den * f.den;
-        return simplify();
+        *this = sum(*this, f, 1);
+        return *this;
     }
     fract operator-=(fract f) {
-        num = num * f.den - den * f.num;
-        den = den * f.den;
-        return simplify();
+        *this = sum(*this, f, -1);
+        return *this;
     }
     fract operator*=(fract f) {
-        num = num * f.num;
-        den = den * f.den;
-        power += f.power;
-        return simplify();
+        set((int64_t)num * f.num, (int64_t)den * f.den, power + f.power);
+        return *this;
     }
     fract operator/=(fract f) {
-        num = num * f.den;
-        den = den * f.num;
-        power -= f.power;
-        return simplify();
+        set((int64_t)num * f.den, (int64_t)den * f.num, power - f.power);
+        return *this;
     }
     fract operator=(fract f) {
         num = f.num;
@@ -322,16 +336,16 @@ public:
         return num != f.num || den != f.den || power != f.power;
     }
     bool operator>(fract f) {
-        return num * f.den * pow(10, power - f.power) > den * f.num;
+        return flib_cmp10((int64_t)num * f.den, power, (int64_t)f.num * den, f.power) > 0;
     }
     bool operator<(fract f) {
-        return num * f.den * pow(10, power - f.power) < den * f.num;
+        return flib_cmp10((int64_t)num * f.den, power, (int64_t)f.num * den, f.power) < 0;
     }
     bool operator>=(fract f) {
-        return num * f.den * pow(10, power - f.power) >= den * f.num;
+        return flib_cmp10((int64_t)num * f.den, power, (int64_t)f.num * den, f.power) >= 0;
     }
     bool operator<=(fract f) {
-        return num * f.den * pow(10, power - f.power) <= den * f.num;
+        return flib_cmp10((int64_t)num * f.den, power, (int64_t)f.num * den, f.power) <= 0;
     }
     fract operator++() {
         num += den;
@@ -404,6 +418,23 @@ public:
         return (double)num / (double)den * pow(10, power);
     }
 
+    // n / d * 10^p as is, for values that are already in the form simplify() gives
+    static fract raw(int32_t n, int32_t d, int8_t p) {
+        fract r;
+        r.num = n;
+        r.den = d;
+        r.power = p;
+        return r;
+    }
+    int32_t getNum() {
+        return num;
+    }
+    int32_t getDen() {
+        return den;
+    }
+    int8_t getPower() {
+        return power;
+    }
     void frcPrint() {
         simplify();
         printf("%ld/%ld*10^%d\n", num, den, power);
@@ -434,6 +465,13 @@ public:
         powden = 0;
         simplify();
     }
+    fracti(int32_t n, int32_t d, int8_t pn, int8_t pd) {
+        num = n;
+        den = d;
+        pownum = pn;
+        powden = pd;
+        simplify();
+    }
     fracti(int32_t n) {
         num = n;
         den = 1;
@@ -467,86 +505,78 @@ public:
             printf("Warning: denominator is 0, answer is undefined.\n");
             return *this;
         }
-        if (den < 0) {
-            num *= -1;
-            den *= -1;
-        }
-        int32_t a = num;
-        int32_t b = den;
-        int32_t c;
-        while (a != 0) {
-            c = a;
-            a = b % a;
-            b = c;
+        set(num, den, pownum - powden);
+        return *this;
+    }
+    // stores n / d * 10^p in lowest terms, with the factors of ten moved into pownum or powden
+    void set(int64_t n, int64_t d, int32_t p) {
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            num = n;
+            den = 0;
+            return;
         }
-        num /= b;
-        den /= b;
-        
-        while (den % 10 == 0) {
-            den /= 10;
-            powden--;
+        flib_normalize10(n, d, p);
+        if (n > INT32_MAX || n < -INT32_MAX || d > INT32_MAX || p > INT8_MAX || p < -INT8_MAX) {
+            printf("Warning: fracti overflow.\n");
         }
-        while(num % 10 == 0 && num != 0) {
-            num /= 10;
-            pownum++;
+        num = n;
+        den = d;
+        pownum = p > 0 ? p : 0;
+        powden = p < 0 ? -p : 0;
+    }
+    // a + sign * b, with the exponents aligned exactly
+    static fracti sum(fracti a, fracti b, int32_t sign) {
+        fracti r;
+        int32_t pa = a.pownum - a.powden;
+        int32_t pb = b.pownum - b.powden;
+        // a zero operand keeps the other's exponent, so it is never scaled
+        int32_t p = a.num == 0 ? pb : (b.num == 0 ? pa : (pa < pb ? pa : pb));
+        int64_t x = (int64_t)a.num * b.den;
+        int64_t y = (int64_t)b.num * a.den * sign;
+        int64_t n;
+        if (!flib_scale10(x, pa - p) || !flib_scale10(y, pb - p) || __builtin_add_overflow(x, y, &n)) {
+            printf("Warning: fracti overflow.\n");
+            return r;
         }
-        return *this;
+        r.set(n, (int64_t)a.den * b.den, p);
+        return r;
+    }
+    // -1, 0 or 1 as *this is less than, equal to or greater than f
+    int32_t cmp(fracti f) {
+        return flib_cmp10((int64_t)num * f.den, pownum - powden, (int64_t)f.num * den, f.pownum - f.powden);
     }
     fracti operator+(fracti f) {
-        fracti r;
-        r.num = num * f.den + den * f.num;
-        r.den = den * f.den;
-        r.pownum = pownum;
-        r.powden = powden;
-        return r.simplify();
+        return sum(*this, f, 1);
     }
     fracti operator-(fracti f) {
-        fracti r;
-        r.num = num * f.den - den * f.num;
-        r.den = den * f.den;
-        r.pownum = pownum;
-        r.powden = powden;
-        return r.simplify();
+        return sum(*this, f, -1);
     }
     fracti operator*(fracti f) {
         fracti r;
-        r.num = num * f.num;
-        r.den = den * f.den;
-        r.pownum = pownum + f.pownum;
-        r.powden = powden + f.powden;
-        return r.simplify();
+        r.set((int64_t)num * f.num, (int64_t)den * f.den, pownum - powden + f.pownum - f.powden);
+        return r;
     }
     fracti operator/(fracti f) {
         fracti r;
-        r.num = num * f.den;
-        r.den = den * f.num;
-        r.pownum = pownum - f.pownum;
-        r.powden = powden - f.powden;
-        return r.simplify();
+        r.set((int64_t)num * f.den, (int64_t)den * f.num, pownum - powden - f.pownum + f.powden);
+        return r;
     }
     fracti operator+=(fracti f) {
-        num = num * f.den + den * f.num;
-        den = den * f.den;
-        return simplify();
+        *this = sum(*this, f, 1);
+        return *this;
     }
     fracti operator-=(fracti f) {
-        num = num * f.den - den * f.num;
-        den = den * f.den;
-        return simplify();
+        *this = sum(*this, f, -1);
+        return *this;
     }
     fracti operator*=(fracti f) {
-        num = num * f.num;
-        den = den * f.den;
-        pownum += f.pownum;
-        powden += f.powden;
-        return simplify();
+        set((int64_t)num * f.num, (int64_t)den * f.den, pownum - powden + f.pownum - f.powden);
+        return *this;
     }
     fracti operator/=(fracti f) {
-        num = num * f.den;
-        den = den * f.num;
-        pownum -= f.pownum;
-        powden -= f.powden;
-        return simplify();
+        set((int64_t)num * f.den, (int64_t)den * f.num, pownum - powden - f.pownum + f.powden);
+        return *this;
     }
     fracti operator=(fracti f) {
         num = f.num;
@@ -579,22 +609,22 @@ public:
         return *this;
     }
     bool operator==(fracti f) {
-        return num * f.den * pow(10, pownum - f.pownum) == den * f.num * pow(10, powden - f.powden);
+        return cmp(f) == 0;
     }
     bool operator!=(fracti f) {
-        return num * f.den * pow(10, pownum - f.pownum) != den * f.num * pow(10, powden - f.powden);
+        return cmp(f) != 0;
     }
     bool operator>(fracti f) {
-        return num * f.den * pow(10, pownum - f.pownum) > den * f.num * pow(10, powden - f.powden);
+        return cmp(f) > 0;
     }
     bool operator<(fracti f) {
-        return num * f.den * pow(10, pownum - f.pownum) < den * f.num * pow(10, powden - f.powden);
+        return cmp(f) < 0;
     }
     bool operator>=(fracti f) {
-        return num * f.den * pow(10, pownum - f.pownum) >= den * f.num * pow(10, powden - f.powden);
+        return cmp(f) >= 0;
     }
     bool operator<=(fracti f) {
-        return num * f.den * pow(10, pownum - f.pownum) <= den * f.num * pow(10, powden - f.powden);
+        return cmp(f) <= 0;
     }
     fracti operator++() {
         num += den;
@@ -724,13 +754,6 @@ public:
         num *= n;
         return *this;
     }
-    fracti operator*(fracti f) {
-        num *= f.num;
-        den *= f.den;
-        pownum += f.pownum;
-        powden += f.powden;
-        return *this;
-    }
     fracti operator*(float f) {
         num *= f;
         pownum += f;
@@ -750,13 +773,6 @@ public:
         num *= n;
         return *this;
     }
-    fracti operator*=(fracti f) {
-        num *= f.num;
-        den *= f.den;
-        pownum += f.pownum;
-        powden += f.powden;
-        return *this;
-    }
     fracti operator*=(float f) {
         num *= f;
         pownum += f;
@@ -776,13 +792,6 @@ public:
         den *= n;
         return *this;
     }
-    fracti operator/(fracti f) {
-        num *= f.den;
-        den *= f.num;
-        pownum -= f.powden;
-        powden -= f.pownum;
-        return *this;
-    }
     fracti operator/(float f) {
         den *= f;
         powden -= f;
@@ -802,13 +811,6 @@ public:
         den *= n;
         return *this;
     }
-    fracti operator/=(fracti f) {
-        num *= f.den;
-        den *= f.num;
-        pownum -= f.powden;
-        powden -= f.pownum;
-        return *this;
-    }
     fracti operator/=(float f) {
         den *= f;
         powden -= f;
@@ -828,13 +830,6 @@ public:
         num += n * den;
         return *this;
     }
-    fracti operator+(fracti f) {
-        num = num * f.den + f.num * den;
-        den *= f.den;
-        pownum += f.pownum;
-        powden += f.powden;
-        return *this;
-    }
     fracti operator+(float f) {
         num += f * den;
         pownum += f;
@@ -854,13 +849,6 @@ public:
         num += n * den;
         return *this;
     }
-    fracti operator+=(fracti f) {
-        num = num * f.den + f.num * den;
-        den *= f.den;
-        pownum += f.pownum;
-        powden += f.powden;
-        return *this;
-    }
     fracti operator+=(float f) {
         num += f * den;
         pownum += f;
@@ -880,13 +868,6 @@ public:
         num -= n * den;
         return *this;
     }
-    fracti operator-(fracti f) {
-        num = num * f.den - f.num * den;
-        den *= f.den;
-        pownum += f.pownum;
-        powden += f.powden;
-        return *this;
-    }
     fracti operator-(float f) {
         num -= f * den;
         pownum += f;
@@ -906,13 +887,6 @@ public:
         num -= n * den;
         return *this;
     }
-    fracti operator-=(fracti f) {
-        num = num * f.den - f.num * den;
-        den *= f.den;
-        pownum += f.pownum;
-        powden += f.powden;
-        return *this;
-    }
 
     operator fract() {
         return (fract)num / (fract)den * (fract)pow(10, pownum - powden);
@@ -930,6 +904,27 @@ public:
         return (frac)num / (frac)den * (frac)pow(10, pownum - powden);
     }
 
+    // (n * 10^pn) / (d * 10^pd) as is, for values that are already in the form simplify() gives
+    static fracti raw(int32_t n, int32_t d, int8_t pn, int8_t pd) {
+        fracti r;
+        r.num = n;
+        r.den = d;
+        r.pownum = pn;
+        r.powden = pd;
+        return r;
+    }
+    int32_t getNum() {
+        return num;
+    }
+    int32_t getDen() {
+        return den;
+    }
+    int8_t getPowNum() {
+        return pownum;
+    }
+    int8_t getPowDen() {
+        return powden;
+    }
     void frcPrint() {
         if (pownum > 0) {
             if (powden > 0) {
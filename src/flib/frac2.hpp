@@ -0,0 +1,284 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include "flib.hpp"
+#include "int128.hpp"
+
+// frac2 {n, p} = n * 2^p
+// dyadic fraction: fract's representation with a power of two instead of ten, which is what binary floats are.
+// every float and double converts exactly, and the numerator is 128 bits so arithmetic on them stays exact:
+// + and - of doubles (53 bit numerators) fit while their exponents are within about 74 of each other
+// (1e6 + 0.1 is fine, 1e20 + 1e-20 is not), and * of two doubles always fits.
+// normalizing is one count trailing zeros and a shift (n is kept odd), + and - align exponents by shifting
+// and * multiplies the odd numerators and adds exponents, so there is never a GCD or a divide.
+// / is only exact when the divisor's numerator divides, otherwise it prints a warning like a zero denominator.
+// results whose numerator outgrows 128 bits print a warning, keep the left operand's value and are flagged,
+// overflowed() tells, and the flag carries through later arithmetic.
+
+class frac2 {
+private:
+    int128_t num; // numerator, odd or 0
+    int32_t power; // power of 2 frac = num * 2^power
+    bool over; // a result this came from did not fit
+
+    // number of significant bits of m
+    static int32_t bits(uint128_t m) {
+        uint64_t hi = (uint64_t)(m >> 64);
+        if (hi != 0) {
+            return 128 - __builtin_clzll(hi);
+        }
+        return m == 0 ? 0 : 64 - __builtin_clzll((uint64_t)m);
+    }
+
+    void set(int128_t n, int32_t p) {
+        if (n == 0) {
+            num = 0;
+            power = 0;
+            return;
+        }
+        uint64_t lo = (uint64_t)n;
+        int32_t z = lo != 0 ? __builtin_ctzll(lo) : 64 + __builtin_ctzll((uint64_t)((uint128_t)n >> 64));
+        num = n >> z;
+        power = p + z;
+    }
+
+    // this value, flagged
+    frac2 overflow() {
+        printf("Warning: frac2 overflow, numerator does not fit in 128 bits.\n");
+        frac2 r = *this;
+        r.over = true;
+        return r;
+    }
+
+    // this + sign * f
+    frac2 sum(frac2 f, int32_t sign) {
+        frac2 r;
+        r.over = over || f.over;
+        if (f.num == 0) {
+            r.num = num;
+            r.power = power;
+            return r;
+        }
+        if (num == 0) {
+            r.num = sign * f.num;
+            r.power = f.power;
+            return r;
+        }
+        // shift the numerator with the larger exponent left, the result is then over the smaller one
+        int128_t a = num;
+        int128_t b = sign * f.num;
+        int32_t p = power < f.power ? power : f.power;
+        int128_t& big = power > f.power ? a : b;
+        int32_t s = power > f.power ? power - f.power : f.power - power;
+        uint128_t m = big < 0 ? -(uint128_t)big : (uint128_t)big;
+        if (s > 0 && (s >= 127 || bits(m) + s > 127)) {
+            return overflow();
+        }
+        big = (int128_t)((uint128_t)big << s);
+        int128_t n;
+        if (__builtin_add_overflow(a, b, &n)) {
+            return overflow();
+        }
+        r.set(n, p);
+        return r;
+    }
+
+    // -1, 0 or 1 as this is less than, equal to or greater than f
+    int32_t cmp(frac2 f) {
+        int32_t sa = num < 0 ? -1 : (num > 0 ? 1 : 0);
+        int32_t sb = f.num < 0 ? -1 : (f.num > 0 ? 1 : 0);
+        if (sa != sb || sa == 0) {
+            return sa < sb ? -1 : (sa > sb ? 1 : 0);
+        }
+        // compare the position of the highest bit first, then the bits below it
+        uint128_t a = num < 0 ? -(uint128_t)num : (uint128_t)num;
+        uint128_t b = f.num < 0 ? -(uint128_t)f.num : (uint128_t)f.num;
+        int64_t ha = (int64_t)bits(a) + power;
+        int64_t hb = (int64_t)bits(b) + f.power;
+        int32_t c;
+        if (ha != hb) {
+            c = ha < hb ? -1 : 1;
+        } else {
+            uint128_t x = a;
+            uint128_t y = b;
+            if (power > f.power) {
+                x <<= power - f.power;
+            } else {
+                y <<= f.power - power;
+            }
+            c = x < y ? -1 : (x > y ? 1 : 0);
+        }
+        return sa * c;
+    }
+
+public:
+    frac2(int64_t n, int32_t p) {
+        over = false;
+        set(n, p);
+    }
+    frac2(int64_t n) {
+        over = false;
+        set(n, 0);
+    }
+    frac2(int32_t n) {
+        over = false;
+        set(n, 0);
+    }
+    frac2() {
+        num = 0;
+        power = 0;
+        over = false;
+    }
+    // exact, every finite double is an integer times a power of 2
+    frac2(double d) {
+        over = false;
+        if (!std::isfinite(d)) {
+            printf("Warning: value is not finite.\n");
+            num = 0;
+            power = 0;
+            return;
+        }
+        int e;
+        double m = std::frexp(d, &e);
+        set((int64_t)std::ldexp(m, 53), e - 53);
+    }
+    frac2(float f) : frac2((double)f) {}
+
+    int128_t getNum() {
+        return num;
+    }
+    int32_t getPower() {
+        return power;
+    }
+    // true if this or a value it was computed from overflowed, the value is then not exact
+    bool overflowed() {
+        return over;
+    }
+    // true if the value converts to frac without rounding
+    bool fitsFrac() {
+        int128_t m = num < 0 ? -num : num;
+        if (power >= 0) {
+            return power < 31 && m <= (INT32_MAX >> power);
+        }
+        return power >= -30 && m <= INT32_MAX;
+    }
+
+    frac2 operator+(frac2 f) {
+        return sum(f, 1);
+    }
+    frac2 operator-(frac2 f) {
+        return sum(f, -1);
+    }
+    frac2 operator*(frac2 f) {
+        frac2 r;
+        if (__builtin_mul_overflow(num, f.num, &r.num)) {
+            return overflow();
+        }
+        r.power = r.num == 0 ? 0 : power + f.power;
+        r.over = over || f.over;
+        return r;
+    }
+    // exact when f's numerator divides this one's
+    frac2 operator/(frac2 f) {
+        frac2 r;
+        if (f.num == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            return r;
+        }
+        if (num % f.num != 0) {
+            printf("Warning: quotient is not a dyadic fraction.\n");
+            return r;
+        }
+        r.set(num / f.num, power - f.power);
+        r.over = over || f.over;
+        return r;
+    }
+    frac2 operator+=(frac2 f) {
+        *this = *this + f;
+        return *this;
+    }
+    frac2 operator-=(frac2 f) {
+        *this = *this - f;
+        return *this;
+    }
+    frac2 operator*=(frac2 f) {
+        *this = *this * f;
+        return *this;
+    }
+    frac2 operator/=(frac2 f) {
+        *this = *this / f;
+        return *this;
+    }
+    frac2 operator-() {
+        frac2 r;
+        r.num = -num;
+        r.power = power;
+        r.over = over;
+        return r;
+    }
+    frac2 operator+() {
+        return *this;
+    }
+    bool operator==(frac2 f) {
+        return num == f.num && power == f.power;
+    }
+    bool operator!=(frac2 f) {
+        return num != f.num || power != f.power;
+    }
+    bool operator>(frac2 f) {
+        return cmp(f) > 0;
+    }
+    bool operator<(frac2 f) {
+        return cmp(f) < 0;
+    }
+    bool operator>=(frac2 f) {
+        return cmp(f) >= 0;
+    }
+    bool operator<=(frac2 f) {
+        return cmp(f) <= 0;
+    }
+
+    operator frac() {
+        if (!fitsFrac()) {
+            printf("Warning: value does not fit in frac.\n");
+            return frac();
+        }
+        if (power >= 0) {
+            return frac((int32_t)(num * ((int64_t)1 << power)));
+        }
+        return frac((int32_t)num, (int32_t)1 << -power);
+    }
+    // n * 2^p is (n * 2^(p-k) / 5^k) * 10^k for p >= 0 and (n * 5^k / 2^(-p-k)) * 10^-k for p < 0,
+    // converts with the first k where both parts fit in 32 bits
+    operator fract() {
+        int128_t m = num < 0 ? -num : num;
+        int32_t q = power < 0 ? -power : power;
+        int64_t f = 1; // 5^k
+        for (int32_t k = 0; k <= q && k <= 13; k++, f *= 5) {
+            if (power >= 0 && q - k <= 31 && m <= (INT32_MAX >> (q - k))) {
+                return fract((int32_t)(num * ((int64_t)1 << (q - k))), (int32_t)f, (int8_t)k);
+            }
+            if (power < 0 && q - k <= 30 && m <= INT32_MAX / f) {
+                return fract((int32_t)(num * f), (int32_t)1 << (q - k), (int8_t)-k);
+            }
+        }
+        printf("Warning: value does not fit in fract.\n");
+        return fract();
+    }
+    operator float() {
+        return (float)(double)*this;
+    }
+    operator double() {
+        return std::ldexp((double)num, power);
+    }
+
+    void frcPrint() {
+        char b[48];
+        sprint128(b, num);
+        printf("%s*2^%d\n", b, power);
+    }
+    void decPrint() {
+        printf("%f\n", (double)*this);
+    }
+};
@@ -0,0 +1,360 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include "flib.hpp"
+#include "int128.hpp"
+
+// fraca {n, d} = n / d, adaptive width
+// no need to pick frac, fract or fracti up front: values start as a pair of 32-bit ints,
+// results that do not fit are promoted to 64 and then 128 bits instead of silently overflowing,
+// and every result is reduced and demoted back to the narrowest width that holds it.
+// the width is a tag next to the value, so when both operands are 32-bit (the common case)
+// one predictable branch leads to frac's arithmetic done in 64 bits.
+// results that do not even fit in 128 bits print a warning like a zero denominator does.
+
+#define FRACA_32 0
+#define FRACA_64 1
+#define FRACA_128 2
+
+class fraca {
+private:
+    union {
+        struct {
+            int32_t num;
+            int32_t den;
+        } w32;
+        struct {
+            int64_t num;
+            int64_t den;
+        } w64;
+        struct {
+            int128_t num;
+            int128_t den;
+        } w128;
+    };
+    uint8_t width; // FRACA_32, FRACA_64 or FRACA_128
+
+    int128_t num128() {
+        return width == FRACA_32 ? w32.num : (width == FRACA_64 ? w64.num : w128.num);
+    }
+    int128_t den128() {
+        return width == FRACA_32 ? w32.den : (width == FRACA_64 ? w64.den : w128.den);
+    }
+
+    // stores n / d (already reduced, d > 0) at the narrowest width
+    void store(int128_t n, int128_t d) {
+        if (n >= -INT32_MAX && n <= INT32_MAX && d <= INT32_MAX) {
+            width = FRACA_32;
+            w32.num = n;
+            w32.den = d;
+        } else if (n >= -INT64_MAX && n <= INT64_MAX && d <= INT64_MAX) {
+            width = FRACA_64;
+            w64.num = n;
+            w64.den = d;
+        } else {
+            width = FRACA_128;
+            w128.num = n;
+            w128.den = d;
+        }
+    }
+
+    // reduces and stores n / d, the 32-bit fast path
+    void set(int64_t n, int64_t d) {
+        if (d == 0) {
+            set((int128_t)n, (int128_t)d);
+            return;
+        }
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        int64_t a = n < 0 ? -n : n;
+        int64_t b = d;
+        int64_t c;
+        while (a != 0) {
+            c = a;
+            a = b % a;
+            b = c;
+        }
+        n /= b;
+        d /= b;
+        if (n >= -INT32_MAX && n <= INT32_MAX && d <= INT32_MAX) {
+            width = FRACA_32;
+            w32.num = n;
+            w32.den = d;
+        } else {
+            width = FRACA_64;
+            w64.num = n;
+            w64.den = d;
+        }
+    }
+
+    // reduces and stores n / d
+    void set(int128_t n, int128_t d) {
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            width = FRACA_32;
+            w32.num = n > 0 ? 1 : (n < 0 ? -1 : 0);
+            w32.den = 0;
+            return;
+        }
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        int128_t g = gcd128(n, d);
+        store(n / g, d / g);
+    }
+
+    void overflow() {
+        printf("Warning: fraca overflow, result does not fit in 128 bits.\n");
+        width = FRACA_32;
+        w32.num = 0;
+        w32.den = 1;
+    }
+
+    static fraca add(int128_t a, int128_t b, int128_t c, int128_t d) {
+        fraca r;
+        int128_t g = gcd128(b, d);
+        int128_t x, y, n, m;
+        if (__builtin_mul_overflow(a, d / g, &x) || __builtin_mul_overflow(c, b / g, &y) ||
+            __builtin_add_overflow(x, y, &n) || __builtin_mul_overflow(b / g, d, &m)) {
+            r.overflow();
+            return r;
+        }
+        r.set(n, m);
+        return r;
+    }
+
+    static fraca mul(int128_t a, int128_t b, int128_t c, int128_t d) {
+        // cross reduce first, so the products are already in lowest terms
+        fraca r;
+        int128_t g1 = gcd128(a, d);
+        int128_t g2 = gcd128(c, b);
+        if (g1 == 0 || g2 == 0) {
+            r.set(a * c, b * d);
+            return r;
+        }
+        int128_t n, m;
+        if (__builtin_mul_overflow(a / g1, c / g2, &n) || __builtin_mul_overflow(b / g2, d / g1, &m)) {
+            r.overflow();
+            return r;
+        }
+        r.set(n, m);
+        return r;
+    }
+
+    // -1, 0 or 1 as a/b is less than, equal to or greater than c/d, b and d > 0
+    static int32_t cmp(int128_t a, int128_t b, int128_t c, int128_t d) {
+        if ((a < 0) != (c < 0)) {
+            return a < 0 ? -1 : 1;
+        }
+        if (a < 0) {
+            return cmp(-c, d, -a, b);
+        }
+        // compare the continued fractions term by term, nothing can overflow
+        int32_t sign = 1;
+        for (;;) {
+            int128_t q1 = a / b;
+            int128_t q2 = c / d;
+            if (q1 != q2) {
+                return q1 < q2 ? -sign : sign;
+            }
+            int128_t r1 = a % b;
+            int128_t r2 = c % d;
+            if (r1 == 0 || r2 == 0) {
+                return r1 == r2 ? 0 : (r1 == 0 ? -sign : sign);
+            }
+            a = b;
+            c = d;
+            b = r1;
+            d = r2;
+            sign = -sign;
+        }
+    }
+
+    int32_t cmp(fraca f) {
+        if (width == FRACA_32 && f.width == FRACA_32) {
+            int64_t x = (int64_t)w32.num * f.w32.den;
+            int64_t y = (int64_t)f.w32.num * w32.den;
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+        return cmp(num128(), den128(), f.num128(), f.den128());
+    }
+
+public:
+    fraca(int32_t n, int32_t d) {
+        set((int64_t)n, (int64_t)d);
+    }
+    fraca(int64_t n, int64_t d) {
+        set((int128_t)n, (int128_t)d);
+    }
+    fraca(int128_t n, int128_t d) {
+        set(n, d);
+    }
+    fraca(int32_t n) {
+        width = FRACA_32;
+        w32.num = n;
+        w32.den = 1;
+    }
+    fraca() {
+        width = FRACA_32;
+        w32.num = 0;
+        w32.den = 1;
+    }
+    fraca(float f) {
+        set((int64_t)(f * 1000000), (int64_t)1000000);
+    }
+    fraca(double d) {
+        set((int64_t)(d * 1000000), (int64_t)1000000);
+    }
+    fraca(frac f) {
+        set((int64_t)f.getNum(), (int64_t)f.getDen());
+    }
+    fraca(fract f) {
+        *this = fraca(f.getNum(), f.getDen()) * fraca::pow10(f.getPower());
+    }
+    fraca(fracti f) {
+        *this = fraca(f.getNum(), f.getDen()) * fraca::pow10(f.getPowNum() - f.getPowDen());
+    }
+
+    // 10^p, exact for |p| <= 38
+    static fraca pow10(int32_t p) {
+        int128_t t = 1;
+        for (int32_t i = p < 0 ? -p : p; i > 0; i--) {
+            if (__builtin_mul_overflow(t, 10, &t)) {
+                fraca r;
+                r.overflow();
+                return r;
+            }
+        }
+        return p < 0 ? fraca((int128_t)1, t) : fraca(t, (int128_t)1);
+    }
+
+    fraca simplify() {
+        set(num128(), den128());
+        return *this;
+    }
+    // FRACA_32, FRACA_64 or FRACA_128
+    uint8_t getWidth() {
+        return width;
+    }
+    int128_t getNum() {
+        return num128();
+    }
+    int128_t getDen() {
+        return den128();
+    }
+
+    fraca operator+(fraca f) {
+        if (width == FRACA_32 && f.width == FRACA_32) {
+            fraca r;
+            r.set((int64_t)w32.num * f.w32.den + (int64_t)f.w32.num * w32.den, (int64_t)w32.den * f.w32.den);
+            return r;
+        }
+        return add(num128(), den128(), f.num128(), f.den128());
+    }
+    fraca operator-(fraca f) {
+        if (width == FRACA_32 && f.width == FRACA_32) {
+            fraca r;
+            r.set((int64_t)w32.num * f.w32.den - (int64_t)f.w32.num * w32.den, (int64_t)w32.den * f.w32.den);
+            return r;
+        }
+        return add(num128(), den128(), -f.num128(), f.den128());
+    }
+    fraca operator*(fraca f) {
+        if (width == FRACA_32 && f.width == FRACA_32) {
+            fraca r;
+            r.set((int64_t)w32.num * f.w32.num, (int64_t)w32.den * f.w32.den);
+            return r;
+        }
+        return mul(num128(), den128(), f.num128(), f.den128());
+    }
+    fraca operator/(fraca f) {
+        if (width == FRACA_32 && f.width == FRACA_32) {
+            fraca r;
+            r.set((int64_t)w32.num * f.w32.den, (int64_t)w32.den * f.w32.num);
+            return r;
+        }
+        int128_t n = f.num128();
+        int128_t d = f.den128();
+        if (n == 0) {
+            fraca r;
+            r.set(num128(), (int128_t)0);
+            return r;
+        }
+        return n < 0 ? mul(num128(), den128(), -d, -n) : mul(num128(), den128(), d, n);
+    }
+    fraca operator+=(fraca f) {
+        *this = *this + f;
+        return *this;
+    }
+    fraca operator-=(fraca f) {
+        *this = *this - f;
+        return *this;
+    }
+    fraca operator*=(fraca f) {
+        *this = *this * f;
+        return *this;
+    }
+    fraca operator/=(fraca f) {
+        *this = *this / f;
+        return *this;
+    }
+    fraca operator-() {
+        fraca r;
+        r.store(-num128(), den128());
+        return r;
+    }
+    fraca operator+() {
+        return *this;
+    }
+    bool operator==(fraca f) {
+        return cmp(f) == 0;
+    }
+    bool operator!=(fraca f) {
+        return cmp(f) != 0;
+    }
+    bool operator>(fraca f) {
+        return cmp(f) > 0;
+    }
+    bool operator<(fraca f) {
+        return cmp(f) < 0;
+    }
+    bool operator>=(fraca f) {
+        return cmp(f) >= 0;
+    }
+    bool operator<=(fraca f) {
+        return cmp(f) <= 0;
+    }
+
+    operator frac() {
+        if (width != FRACA_32) {
+            printf("Warning: value does not fit in frac.\n");
+        }
+        return frac((int32_t)num128(), (int32_t)den128());
+    }
+    operator fract() {
+        if (width != FRACA_32) {
+            printf("Warning: value does not fit in fract.\n");
+        }
+        return fract((int32_t)num128(), (int32_t)den128());
+    }
+    operator float() {
+        return (float)(double)*this;
+    }
+    operator double() {
+        return (double)num128() / (double)den128();
+    }
+
+    void frcPrint() {
+        char n[48], d[48];
+        sprint128(n, num128());
+        sprint128(d, den128());
+        printf("%s/%s\n", n, d);
+    }
+    void decPrint() {
+        printf("%f\n", (double)*this);
+    }
+};
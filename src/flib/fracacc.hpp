@@ -0,0 +1,318 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include "flib.hpp"
+#include "int128.hpp"
+
+// fracacc: concurrent exact sum of fracs, for counters many threads add into
+//
+// fast path: the sum lives in one 64-bit word holding a packed frac {num, den}, updated with compare and swap.
+// when the new sum would not fit in 32 bits, or the CAS keeps failing because other threads are adding,
+// the value goes into the calling thread's shard instead: a 128-bit partial sum only that thread writes.
+// every live thread that adds owns a slot number (claimed on its first add, released when it exits, so a new
+// thread reuses it), and slot i is shard i in every fracacc, so shards have a single writer and need no lock or CAS.
+// shards come in blocks of FRACACC_SHARDS, the first block is inline and more are appended with CAS when more
+// threads are alive at once, so memory grows with the most threads ever adding at the same time, never with adds.
+// a shard keeps two copies of its value: the owner writes the copy readers are not told about, then bumps
+// the shard's sequence number to publish it, so a reader always has a complete copy even if the owner stops mid-write.
+//
+// snapshot() merges the central word and every shard exactly. it is linearizable: it reads every shard with its
+// sequence number, reads the central word at some instant t, then checks that no shard sequence moved and no block
+// was appended, so the shards held the values read at t and the result is the exact sum at t. it retries while adds land, and each retry means some add finished,
+// so nothing ever waits on a stalled thread (lock-free, not wait-free).
+
+#define FRACACC_SHARDS 64
+#define FRACACC_RETRIES 4
+
+class fracacc {
+private:
+    struct alignas(64) shard {
+        std::atomic<uint64_t> seq; // number of writes, the current value is copy seq & 1
+        std::atomic<uint64_t> num[2][2]; // two copies of the 128-bit partial sum num / den, low word first
+        std::atomic<uint64_t> den[2][2];
+    };
+
+    struct block {
+        shard shards[FRACACC_SHARDS];
+        std::atomic<block*> next;
+    };
+
+    // which slot numbers live threads own, one bit each, shared by every fracacc and never freed
+    struct slots {
+        std::atomic<uint64_t> used;
+        std::atomic<slots*> next;
+    };
+
+    // the slot number of a live thread, released when it exits
+    struct owner {
+        int32_t s;
+        ~owner() {
+            slots* u = &used();
+            for (int32_t k = s / FRACACC_SHARDS; k > 0; k--) {
+                u = u->next.load(std::memory_order_acquire);
+            }
+            u->used.fetch_and(~((uint64_t)1 << (s % FRACACC_SHARDS)), std::memory_order_release);
+        }
+    };
+
+    static_assert(FRACACC_SHARDS <= 64, "fracacc: slots are bits of one 64-bit word");
+
+    alignas(64) std::atomic<uint64_t> central;
+    block first;
+
+    static uint64_t pack(int32_t n, int32_t d) {
+        return (uint64_t)(uint32_t)n | ((uint64_t)(uint32_t)d << 32);
+    }
+    static int32_t unpackNum(uint64_t w) {
+        return (int32_t)(uint32_t)w;
+    }
+    static int32_t unpackDen(uint64_t w) {
+        return (int32_t)(uint32_t)(w >> 32);
+    }
+
+    static int128_t load128(std::atomic<uint64_t>* w) {
+        return (int128_t)(((uint128_t)w[1].load(std::memory_order_relaxed) << 64) | w[0].load(std::memory_order_relaxed));
+    }
+    static void store128(std::atomic<uint64_t>* w, int128_t v) {
+        w[0].store((uint64_t)v, std::memory_order_relaxed);
+        w[1].store((uint64_t)((uint128_t)v >> 64), std::memory_order_relaxed);
+    }
+
+    // n / d += a / b exactly, false on overflow
+    static bool add128(int128_t& n, int128_t& d, int128_t a, int128_t b) {
+        if (a == 0) {
+            return true;
+        }
+        if (d == b) {
+            return !__builtin_add_overflow(n, a, &n);
+        }
+        int128_t g = gcd128(d, b);
+        int128_t x, y, z;
+        if (__builtin_mul_overflow(n, b / g, &x) || __builtin_mul_overflow(a, d / g, &y) ||
+            __builtin_add_overflow(x, y, &z) || __builtin_mul_overflow(d / g, b, &d)) {
+            return false;
+        }
+        n = z;
+        g = gcd128(n, d);
+        if (g > 1) {
+            n /= g;
+            d /= g;
+        }
+        return true;
+    }
+
+    static slots& used() {
+        static slots u = {{0}, {NULL}};
+        return u;
+    }
+
+    static void clear(block* b) {
+        b->next.store(NULL);
+        for (int32_t i = 0; i < FRACACC_SHARDS; i++) {
+            b->shards[i].seq.store(0);
+            for (int32_t c = 0; c < 2; c++) {
+                store128(b->shards[i].num[c], 0);
+                store128(b->shards[i].den[c], 1);
+            }
+        }
+    }
+
+    // the lowest free slot number, appends a slot word when every one is taken
+    static int32_t claim() {
+        uint64_t all = FRACACC_SHARDS == 64 ? ~(uint64_t)0 : ((uint64_t)1 << FRACACC_SHARDS) - 1;
+        slots* u = &used();
+        for (int32_t k = 0;; k++) {
+            uint64_t w = u->used.load(std::memory_order_relaxed);
+            while ((w & all) != all) {
+                int32_t s = __builtin_ctzll(~w);
+                if (u->used.compare_exchange_weak(w, w | ((uint64_t)1 << s), std::memory_order_acquire)) {
+                    return k * FRACACC_SHARDS + s;
+                }
+            }
+            slots* next = u->next.load(std::memory_order_acquire);
+            if (next == NULL) {
+                slots* e = new slots{{0}, {NULL}};
+                if (u->next.compare_exchange_strong(next, e, std::memory_order_acq_rel)) {
+                    next = e;
+                } else {
+                    delete e;
+                }
+            }
+            u = next;
+        }
+    }
+
+    // the calling thread's slot number
+    static int32_t slot() {
+        static thread_local owner o = {claim()};
+        return o.s;
+    }
+
+    // shard i of this fracacc, appending blocks up to it if they do not exist yet
+    shard& at(int32_t i) {
+        block* b = &first;
+        for (int32_t k = i / FRACACC_SHARDS; k > 0; k--) {
+            block* next = b->next.load(std::memory_order_acquire);
+            if (next == NULL) {
+                block* e = new block;
+                clear(e);
+                if (b->next.compare_exchange_strong(next, e, std::memory_order_acq_rel)) {
+                    next = e;
+                } else {
+                    delete e;
+                }
+            }
+            b = next;
+        }
+        return b->shards[i % FRACACC_SHARDS];
+    }
+
+    void addShard(int32_t n, int32_t d) {
+        shard& sh = at(slot());
+        // only this thread writes the shard, readers use copy s & 1 until seq moves to s + 1
+        uint64_t s = sh.seq.load(std::memory_order_acquire);
+        int128_t sn = load128(sh.num[s & 1]);
+        int128_t sd = load128(sh.den[s & 1]);
+        if (!add128(sn, sd, n, d)) {
+            printf("Warning: fracacc overflow, value dropped.\n");
+            return;
+        }
+        // a reader that sees any of the stores below also sees seq >= s, so it knows copy (s + 1) & 1 is not settled
+        std::atomic_thread_fence(std::memory_order_release);
+        store128(sh.num[(s + 1) & 1], sn);
+        store128(sh.den[(s + 1) & 1], sd);
+        sh.seq.store(s + 1, std::memory_order_release);
+    }
+
+public:
+    fracacc() {
+        central.store(pack(0, 1));
+        clear(&first);
+    }
+    ~fracacc() {
+        block* b = first.next.load();
+        while (b != NULL) {
+            block* next = b->next.load();
+            delete b;
+            b = next;
+        }
+    }
+    fracacc(const fracacc&) = delete;
+    fracacc& operator=(const fracacc&) = delete;
+
+    void add(frac f) {
+        int32_t fn = f.getNum();
+        int32_t fd = f.getDen();
+        if (fd == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            return;
+        }
+        uint64_t old = central.load(std::memory_order_relaxed);
+        for (int32_t i = 0; i < FRACACC_RETRIES; i++) {
+            int64_t n = unpackNum(old);
+            int64_t d = unpackDen(old);
+            if (d == fd) {
+                n += fn;
+            } else {
+                n = n * fd + d * fn;
+                d = d * fd;
+                int64_t a = n < 0 ? -n : n;
+                int64_t b = d;
+                int64_t c;
+                while (a != 0) {
+                    c = a;
+                    a = b % a;
+                    b = c;
+                }
+                n /= b;
+                d /= b;
+            }
+            if (n > INT32_MAX || n < -INT32_MAX || d > INT32_MAX) {
+                break;
+            }
+            if (central.compare_exchange_weak(old, pack(n, d), std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        addShard(fn, fd);
+    }
+    void sub(frac f) {
+        add(frac(0) - f);
+    }
+    void operator+=(frac f) {
+        add(f);
+    }
+    void operator-=(frac f) {
+        sub(f);
+    }
+
+    // exact sum at one instant, reduced, false if it does not fit in 128 bits
+    bool snapshot(int128_t& n, int128_t& d) {
+        std::vector<uint64_t> seqs;
+        std::vector<int128_t> sn;
+        std::vector<int128_t> sd;
+        for (;;) {
+            seqs.clear();
+            sn.clear();
+            sd.clear();
+            block* last = &first;
+            for (block* b = &first; b != NULL; b = b->next.load(std::memory_order_acquire)) {
+                for (int32_t i = 0; i < FRACACC_SHARDS; i++) {
+                    uint64_t s = b->shards[i].seq.load(std::memory_order_acquire);
+                    seqs.push_back(s);
+                    sn.push_back(load128(b->shards[i].num[s & 1]));
+                    sd.push_back(load128(b->shards[i].den[s & 1]));
+                }
+                last = b;
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t c = central.load(std::memory_order_seq_cst);
+            // a block appended after the walk could already hold values
+            bool moved = last->next.load(std::memory_order_seq_cst) != NULL;
+            size_t k = 0;
+            for (block* b = &first; b != NULL && !moved; b = b->next.load(std::memory_order_acquire)) {
+                for (int32_t i = 0; i < FRACACC_SHARDS && !moved; i++, k++) {
+                    moved = b->shards[i].seq.load(std::memory_order_seq_cst) != seqs[k];
+                }
+            }
+            if (moved) {
+                continue;
+            }
+            n = unpackNum(c);
+            d = unpackDen(c);
+            for (size_t i = 0; i < seqs.size(); i++) {
+                if (!add128(n, d, sn[i], sd[i])) {
+                    return false;
+                }
+            }
+            int128_t g = gcd128(n, d);
+            n /= g;
+            d /= g;
+            return true;
+        }
+    }
+
+    // the sum as a frac, with a warning if it does not fit
+    frac load() {
+        int128_t n, d;
+        if (!snapshot(n, d) || n > INT32_MAX || n < -INT32_MAX || d > INT32_MAX) {
+            printf("Warning: fracacc sum does not fit in frac.\n");
+            return frac();
+        }
+        return frac((int32_t)n, (int32_t)d);
+    }
+    operator frac() {
+        return load();
+    }
+
+    void frcPrint() {
+        frac f = load();
+        f.frcPrint();
+    }
+    void decPrint() {
+        frac f = load();
+        f.decPrint();
+    }
+};
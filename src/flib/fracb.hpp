@@ -0,0 +1,298 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include "flib.hpp"
+
+// fracb<N> {n, d} = n / d, with d <= N
+// every result is rounded to the closest fraction whose denominator is at most N
+// (best rational approximation, found by walking the continued fraction of the exact result,
+// i.e. descending the Stern-Brocot tree), so long running computations stay in 32-bit storage
+// instead of overflowing like frac or needing fracti or double.
+// intermediate results are computed exactly in 64 bits before rounding.
+//
+// error bounds:
+// one rounding moves a value by at most 1 / (2 * N) while |value| <= INT32_MAX / N
+// (the neighbours a/b < x < c/d of x in the Farey sequence of order N are 1 / (b * d) apart, and b * d >= N).
+// maxStepError() returns that bound.
+// error() returns a bound on |value - exact value| for the whole computation that produced the value:
+// each operation adds its own rounding error to the propagated error of its operands.
+// the bound is carried in a double, so it is accurate to double precision, not rigorous in the last bit.
+
+template <int32_t N>
+class fracb {
+    static_assert(N > 0, "fracb: denominator bound must be positive");
+
+private:
+    int32_t num; // numerator
+    int32_t den; // denominator, 0 < den <= N
+    double err; // bound on |num / den - exact value|
+
+    static uint64_t gcd(uint64_t a, uint64_t b) {
+        uint64_t c;
+        while (a != 0) {
+            c = a;
+            a = b % a;
+            b = c;
+        }
+        return b;
+    }
+
+    // sets num / den to the closest fraction to n / d with den <= N and |num| <= INT32_MAX
+    // returns |n / d - num / den|
+    double round(int64_t n, int64_t d) {
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            num = n > 0 ? 1 : (n < 0 ? -1 : 0);
+            den = 0;
+            return INFINITY;
+        }
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        bool neg = n < 0;
+        uint64_t un = neg ? -(uint64_t)n : (uint64_t)n;
+        uint64_t ud = d;
+        uint64_t g = gcd(un, ud);
+        un /= g;
+        ud /= g;
+
+        if (ud <= (uint64_t)N && un <= (uint64_t)INT32_MAX) {
+            num = neg ? -(int32_t)un : (int32_t)un;
+            den = ud;
+            return 0;
+        }
+        if (un / ud >= (uint64_t)INT32_MAX) {
+            printf("Warning: fracb overflow, value clamped.\n");
+            num = neg ? -INT32_MAX : INT32_MAX;
+            den = 1;
+            return (double)un / (double)ud - INT32_MAX;
+        }
+
+        // convergents p0/q0, p1/q1 of un / ud, stopping before either bound is exceeded
+        uint64_t p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+        uint64_t a, r, n_ = un, d_ = ud;
+        while (d_ != 0) {
+            a = n_ / d_;
+            if (q1 != 0 && a > ((uint64_t)N - q0) / q1) {
+                break;
+            }
+            if (a > ((uint64_t)INT32_MAX - p0) / p1) {
+                break;
+            }
+            r = p0 + a * p1;
+            p0 = p1;
+            p1 = r;
+            r = q0 + a * q1;
+            q0 = q1;
+            q1 = r;
+            r = n_ - a * d_;
+            n_ = d_;
+            d_ = r;
+        }
+
+        // the best approximation is either the last convergent or the largest semiconvergent that fits
+        uint64_t k = ((uint64_t)N - q0) / q1;
+        if (p1 != 0 && ((uint64_t)INT32_MAX - p0) / p1 < k) {
+            k = ((uint64_t)INT32_MAX - p0) / p1;
+        }
+        uint64_t ps = p0 + k * p1;
+        uint64_t qs = q0 + k * q1;
+
+        // |un/ud - p/q| = |un * q - p * ud| / (ud * q)
+        unsigned __int128 e1 = (unsigned __int128)un * q1;
+        unsigned __int128 t = (unsigned __int128)p1 * ud;
+        e1 = e1 > t ? e1 - t : t - e1;
+        unsigned __int128 es = (unsigned __int128)un * qs;
+        t = (unsigned __int128)ps * ud;
+        es = es > t ? es - t : t - es;
+
+        double e;
+        if (qs != 0 && es * q1 < e1 * qs) {
+            num = neg ? -(int32_t)ps : (int32_t)ps;
+            den = qs;
+            e = (double)es / ((double)ud * (double)qs);
+        } else {
+            num = neg ? -(int32_t)p1 : (int32_t)p1;
+            den = q1;
+            e = (double)e1 / ((double)ud * (double)q1);
+        }
+        return e;
+    }
+
+    // rounds a double exactly (by its binary expansion, not by a fixed scale like frac)
+    double roundDouble(double v) {
+        if (std::isnan(v) || fabs(v) >= INT32_MAX) {
+            return round(v > 0 ? INT32_MAX : -INT32_MAX, std::isnan(v) ? 0 : 1);
+        }
+        int e;
+        frexp(v, &e);
+        int k = 61 - e;
+        if (k > 62) {
+            k = 62;
+        }
+        int64_t n = llround(ldexp(v, k));
+        double trunc = fabs(ldexp((double)n, -k) - v);
+        return round(n, (int64_t)1 << k) + trunc;
+    }
+
+public:
+    fracb(int32_t n, int32_t d) {
+        err = round(n, d);
+    }
+    fracb(int32_t n) {
+        err = round(n, 1);
+    }
+    fracb() {
+        num = 0;
+        den = 1;
+        err = 0;
+    }
+    fracb(float f) {
+        err = roundDouble(f);
+    }
+    fracb(double d) {
+        err = roundDouble(d);
+    }
+    fracb(frac f) {
+        err = round(f.getNum(), f.getDen());
+    }
+    fracb(fract f) {
+        int64_t n = f.getNum();
+        int64_t d = f.getDen();
+        double trunc = 0;
+        for (int8_t p = f.getPower(); p > 0; p--) {
+            if (n > INT64_MAX / 10 || n < -INT64_MAX / 10) {
+                n = n > 0 ? INT64_MAX / 2 : -INT64_MAX / 2;
+                d = 1;
+                break;
+            }
+            n *= 10;
+        }
+        for (int8_t p = f.getPower(); p < 0; p++) {
+            if (d > INT64_MAX / 10) {
+                // too small to matter at this precision, drop a digit of the numerator instead
+                trunc += 1.0 / (double)d;
+                n /= 10;
+                continue;
+            }
+            d *= 10;
+        }
+        err = round(n, d) + trunc;
+    }
+
+    // largest error a single rounding can introduce (for |value| <= INT32_MAX / N)
+    static double maxStepError() {
+        return 1.0 / (2.0 * N);
+    }
+    // bound on |value - exact value| accumulated over the computation that produced this value
+    double error() {
+        return err;
+    }
+    int32_t getNum() {
+        return num;
+    }
+    int32_t getDen() {
+        return den;
+    }
+
+    fracb operator+(fracb f) {
+        fracb r;
+        double e = r.round((int64_t)num * f.den + (int64_t)den * f.num, (int64_t)den * f.den);
+        r.err = err + f.err + e;
+        return r;
+    }
+    fracb operator-(fracb f) {
+        fracb r;
+        double e = r.round((int64_t)num * f.den - (int64_t)den * f.num, (int64_t)den * f.den);
+        r.err = err + f.err + e;
+        return r;
+    }
+    fracb operator*(fracb f) {
+        fracb r;
+        double e = r.round((int64_t)num * f.num, (int64_t)den * f.den);
+        r.err = fabs((double)*this) * f.err + fabs((double)f) * err + err * f.err + e;
+        return r;
+    }
+    fracb operator/(fracb f) {
+        fracb r;
+        double e = r.round((int64_t)num * f.den, (int64_t)den * f.num);
+        double a = fabs((double)*this);
+        double b = fabs((double)f);
+        if (b > f.err) {
+            r.err = (a * f.err + b * err) / (b * (b - f.err)) + e;
+        } else {
+            r.err = INFINITY;
+        }
+        return r;
+    }
+    fracb operator+=(fracb f) {
+        *this = *this + f;
+        return *this;
+    }
+    fracb operator-=(fracb f) {
+        *this = *this - f;
+        return *this;
+    }
+    fracb operator*=(fracb f) {
+        *this = *this * f;
+        return *this;
+    }
+    fracb operator/=(fracb f) {
+        *this = *this / f;
+        return *this;
+    }
+    fracb operator-() {
+        fracb r = *this;
+        r.num = -num;
+        return r;
+    }
+    fracb operator+() {
+        return *this;
+    }
+    bool operator==(fracb f) {
+        return num == f.num && den == f.den;
+    }
+    bool operator!=(fracb f) {
+        return num != f.num || den != f.den;
+    }
+    bool operator>(fracb f) {
+        return (int64_t)num * f.den > (int64_t)den * f.num;
+    }
+    bool operator<(fracb f) {
+        return (int64_t)num * f.den < (int64_t)den * f.num;
+    }
+    bool operator>=(fracb f) {
+        return (int64_t)num * f.den >= (int64_t)den * f.num;
+    }
+    bool operator<=(fracb f) {
+        return (int64_t)num * f.den <= (int64_t)den * f.num;
+    }
+
+    operator frac() {
+        return frac(num, den);
+    }
+    operator fract() {
+        return fract(num, den);
+    }
+    operator float() {
+        return (float)num / (float)den;
+    }
+    operator double() {
+        return (double)num / (double)den;
+    }
+    operator int32_t() {
+        return num / den;
+    }
+
+    void frcPrint() {
+        printf("%d/%d\n", num, den);
+    }
+    void decPrint() {
+        printf("%f\n", (double)num / (double)den);
+    }
+    void errPrint() {
+        printf("+/- %g\n", err);
+    }
+};
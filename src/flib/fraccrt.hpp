@@ -0,0 +1,358 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "flib.hpp"
+#include "int128.hpp"
+
+// multi-modular exact computation
+//
+// exact determinants, linear solves and dot products blow up any fixed width fraction in the intermediate steps,
+// even when the answer is small. instead, the computation is run modulo several primes just below 2^31,
+// where every step is a 64-bit multiply and a remainder, and each prime runs on its own thread.
+// the residues are combined with the chinese remainder theorem into r mod M (M = product of the primes),
+// and the fraction n / d with n = r * d mod M and |n|, d <= sqrt(M / 2) is recovered by rational reconstruction.
+// a result is accepted once it also matches the residue of a prime that was not used to build it,
+// so small answers need two or three primes however large the input is.
+// M is at most FRACCRT_PRIMES primes (124 bits), so answers are found when |n| and d are below about 2^61.
+//
+// fraccrt(f, k, num, den, threads) is the engine: f(q, r) writes k residues mod the prime q into r,
+// and returns false if q is a bad prime for this input (a denominator divisible by q, a pivot that vanishes mod q).
+// fraccrtDet, fraccrtSolve and fraccrtDot are built on it for arrays of frac or fract.
+
+#define FRACCRT_PRIMES 4
+#define FRACCRT_TRIES 64
+
+static inline uint32_t fraccrtPow(uint64_t a, uint64_t e, uint32_t q) {
+    uint64_t r = 1;
+    a %= q;
+    while (e != 0) {
+        if (e & 1) {
+            r = r * a % q;
+        }
+        a = a * a % q;
+        e >>= 1;
+    }
+    return (uint32_t)r;
+}
+
+// 1 / a mod the prime q, a != 0 mod q
+static inline uint32_t fraccrtInv(uint32_t a, uint32_t q) {
+    return fraccrtPow(a, q - 2, q);
+}
+
+// the largest prime below q
+static inline uint32_t fraccrtNextPrime(uint32_t q) {
+    for (;;) {
+        q -= 2;
+        bool prime = true;
+        for (uint32_t p = 3; (uint64_t)p * p <= q && prime; p += 2) {
+            prime = q % p != 0;
+        }
+        if (prime) {
+            return q;
+        }
+    }
+}
+
+// n mod q for any sign of n
+static inline uint32_t fraccrtMod(int64_t n, uint32_t q) {
+    int64_t r = n % (int64_t)q;
+    return (uint32_t)(r < 0 ? r + q : r);
+}
+
+// f mod q, false if its denominator is divisible by q
+static inline bool fraccrtMod(frac f, uint32_t q, uint32_t& r) {
+    uint32_t d = fraccrtMod(f.getDen(), q);
+    if (d == 0) {
+        return false;
+    }
+    r = (uint64_t)fraccrtMod(f.getNum(), q) * fraccrtInv(d, q) % q;
+    return true;
+}
+static inline bool fraccrtMod(fract f, uint32_t q, uint32_t& r) {
+    uint32_t d = fraccrtMod(f.getDen(), q);
+    if (d == 0) {
+        return false;
+    }
+    int32_t p = f.getPower();
+    uint32_t t = fraccrtPow(10, p < 0 ? -p : p, q);
+    r = (uint64_t)fraccrtMod(f.getNum(), q) * (p < 0 ? fraccrtInv(t, q) : t) % q;
+    r = (uint64_t)r * fraccrtInv(d, q) % q;
+    return true;
+}
+
+static inline uint128_t fraccrtSqrt(uint128_t m) {
+    uint128_t x = (uint128_t)1 << 64;
+    for (;;) {
+        uint128_t y = (x + m / x) / 2;
+        if (y >= x) {
+            return x;
+        }
+        x = y;
+    }
+}
+
+// n / d with n = r * d mod m, |n| and d <= sqrt(m / 2), false if there is none
+static inline bool fraccrtReconstruct(uint128_t r, uint128_t m, int128_t& n, int128_t& d) {
+    int128_t b = fraccrtSqrt(m / 2);
+    int128_t r0 = m;
+    int128_t r1 = r;
+    int128_t t0 = 0;
+    int128_t t1 = 1;
+    int128_t c;
+    while (r1 > b) {
+        int128_t q = r0 / r1;
+        c = r0 - q * r1;
+        r0 = r1;
+        r1 = c;
+        c = t0 - q * t1;
+        t0 = t1;
+        t1 = c;
+    }
+    if (t1 == 0 || t1 > b || t1 < -b || gcd128(r1, t1) != 1) {
+        return false;
+    }
+    n = t1 < 0 ? -r1 : r1;
+    d = t1 < 0 ? -t1 : t1;
+    return true;
+}
+
+// num[i] / den[i] for the k results f computes mod each prime, false if they need more than FRACCRT_PRIMES primes
+template <typename F>
+bool fraccrt(F f, int32_t k, int128_t* num, int128_t* den, int32_t threads = 1) {
+    threads = threads < 1 ? 1 : threads;
+    uint128_t m = 1; // product of the primes combined so far
+    std::vector<uint128_t> r(k, 0); // results mod m
+    int32_t used = 0;
+    bool found = false; // num / den hold a reconstruction of every result
+    uint32_t q = 2147483647u;
+    std::vector<uint32_t> qs(threads);
+    std::vector<std::vector<uint32_t>> rs(threads, std::vector<uint32_t>(k));
+    std::vector<char> ok(threads);
+    for (int32_t tries = 0; tries < FRACCRT_TRIES; tries += threads) {
+        // one residue per thread
+        for (int32_t t = 0; t < threads; t++) {
+            qs[t] = q;
+            q = fraccrtNextPrime(q);
+        }
+        std::vector<std::thread> pool;
+        for (int32_t t = 1; t < threads; t++) {
+            pool.emplace_back([&, t]() { ok[t] = f(qs[t], rs[t].data()); });
+        }
+        ok[0] = f(qs[0], rs[0].data());
+        for (std::thread& th : pool) {
+            th.join();
+        }
+        for (int32_t t = 0; t < threads; t++) {
+            if (!ok[t]) {
+                continue;
+            }
+            uint32_t p = qs[t];
+            const uint32_t* a = rs[t].data();
+            // check the current reconstruction against this prime
+            bool match = found;
+            for (int32_t i = 0; i < k && match; i++) {
+                match = fraccrtMod((int64_t)(num[i] % p), p) == (uint64_t)a[i] * fraccrtMod((int64_t)(den[i] % p), p) % p;
+            }
+            if (match) {
+                return true;
+            }
+            if (used == FRACCRT_PRIMES) {
+                printf("Warning: fraccrt result does not fit in 128 bits.\n");
+                return false;
+            }
+            // combine: r += m * ((a - r) / m mod p)
+            uint32_t mi = fraccrtInv((uint32_t)(m % p), p);
+            for (int32_t i = 0; i < k; i++) {
+                uint32_t c = (uint32_t)(r[i] % p);
+                uint64_t s = (uint64_t)(a[i] + p - c) % p * mi % p;
+                r[i] += m * s;
+            }
+            m *= p;
+            used++;
+            // without a candidate for every result, the next prime is combined too
+            found = true;
+            for (int32_t i = 0; i < k && found; i++) {
+                found = fraccrtReconstruct(r[i], m, num[i], den[i]);
+            }
+        }
+    }
+    printf("Warning: fraccrt found no usable primes.\n");
+    return false;
+}
+
+// det mod q of the n x n row-major matrix, by gaussian elimination, false for a bad prime
+template <typename T>
+bool fraccrtDetMod(const T* a, int32_t n, uint32_t q, uint32_t* det) {
+    std::vector<uint32_t> m((size_t)n * n);
+    for (size_t i = 0; i < m.size(); i++) {
+        if (!fraccrtMod(a[i], q, m[i])) {
+            return false;
+        }
+    }
+    uint64_t d = 1;
+    for (int32_t c = 0; c < n; c++) {
+        int32_t p = c;
+        while (p < n && m[(size_t)p * n + c] == 0) {
+            p++;
+        }
+        if (p == n) {
+            *det = 0;
+            return true;
+        }
+        if (p != c) {
+            for (int32_t j = c; j < n; j++) {
+                uint32_t t = m[(size_t)p * n + j];
+                m[(size_t)p * n + j] = m[(size_t)c * n + j];
+                m[(size_t)c * n + j] = t;
+            }
+            d = q - d;
+        }
+        uint32_t* row = &m[(size_t)c * n];
+        d = d * row[c] % q;
+        uint64_t inv = fraccrtInv(row[c], q);
+        for (int32_t i = c + 1; i < n; i++) {
+            uint32_t* other = &m[(size_t)i * n];
+            uint64_t s = other[c] * inv % q;
+            if (s == 0) {
+                continue;
+            }
+            for (int32_t j = c + 1; j < n; j++) {
+                other[j] = (other[j] + (uint64_t)(q - s) * row[j]) % q;
+            }
+        }
+    }
+    *det = (uint32_t)(d % q);
+    return true;
+}
+
+// x mod q with a * x = b, false for a bad prime (including a matrix that is singular mod q)
+template <typename T>
+bool fraccrtSolveMod(const T* a, const T* b, int32_t n, uint32_t q, uint32_t* x) {
+    int32_t w = n + 1;
+    std::vector<uint32_t> m((size_t)n * w);
+    for (int32_t i = 0; i < n; i++) {
+        for (int32_t j = 0; j < n; j++) {
+            if (!fraccrtMod(a[(size_t)i * n + j], q, m[(size_t)i * w + j])) {
+                return false;
+            }
+        }
+        if (!fraccrtMod(b[i], q, m[(size_t)i * w + n])) {
+            return false;
+        }
+    }
+    for (int32_t c = 0; c < n; c++) {
+        int32_t p = c;
+        while (p < n && m[(size_t)p * w + c] == 0) {
+            p++;
+        }
+        if (p == n) {
+            return false;
+        }
+        if (p != c) {
+            for (int32_t j = c; j < w; j++) {
+                uint32_t t = m[(size_t)p * w + j];
+                m[(size_t)p * w + j] = m[(size_t)c * w + j];
+                m[(size_t)c * w + j] = t;
+            }
+        }
+        uint32_t* row = &m[(size_t)c * w];
+        uint64_t inv = fraccrtInv(row[c], q);
+        for (int32_t j = c; j < w; j++) {
+            row[j] = row[j] * inv % q;
+        }
+        for (int32_t i = 0; i < n; i++) {
+            uint32_t* other = &m[(size_t)i * w];
+            uint64_t s = other[c];
+            if (i == c || s == 0) {
+                continue;
+            }
+            for (int32_t j = c; j < w; j++) {
+                other[j] = (other[j] + (uint64_t)(q - s) * row[j]) % q;
+            }
+        }
+    }
+    for (int32_t i = 0; i < n; i++) {
+        x[i] = m[(size_t)i * w + n];
+    }
+    return true;
+}
+
+// sum of a[i] * b[i] mod q, false for a bad prime
+template <typename T>
+bool fraccrtDotMod(const T* a, const T* b, size_t n, uint32_t q, uint32_t* s) {
+    uint64_t r = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x, y;
+        if (!fraccrtMod(a[i], q, x) || !fraccrtMod(b[i], q, y)) {
+            return false;
+        }
+        r = (r + (uint64_t)x * y) % q;
+    }
+    *s = (uint32_t)r;
+    return true;
+}
+
+// num / den = determinant of the n x n row-major matrix a (frac or fract)
+template <typename T>
+bool fraccrtDet(const T* a, int32_t n, int128_t& num, int128_t& den, int32_t threads = 1) {
+    return fraccrt([&](uint32_t q, uint32_t* r) { return fraccrtDetMod(a, n, q, r); }, 1, &num, &den, threads);
+}
+
+// num[i] / den[i] = x[i] with a * x = b, a n x n row-major, false if a is singular
+template <typename T>
+bool fraccrtSolve(const T* a, const T* b, int32_t n, int128_t* num, int128_t* den, int32_t threads = 1) {
+    int128_t dn, dd;
+    if (!fraccrtDet(a, n, dn, dd, threads)) {
+        return false;
+    }
+    if (dn == 0) {
+        printf("Warning: matrix is singular, no unique solution.\n");
+        return false;
+    }
+    return fraccrt([&](uint32_t q, uint32_t* r) { return fraccrtSolveMod(a, b, n, q, r); }, n, num, den, threads);
+}
+
+// num / den = sum of a[i] * b[i]
+template <typename T>
+bool fraccrtDot(const T* a, const T* b, size_t n, int128_t& num, int128_t& den, int32_t threads = 1) {
+    return fraccrt([&](uint32_t q, uint32_t* r) { return fraccrtDotMod(a, b, n, q, r); }, 1, &num, &den, threads);
+}
+
+// the same results as fracs, with a warning if they do not fit
+static inline frac fraccrtFrac(int128_t n, int128_t d) {
+    if (n > INT32_MAX || n < -INT32_MAX || d > INT32_MAX) {
+        printf("Warning: result does not fit in frac.\n");
+        return frac();
+    }
+    return frac((int32_t)n, (int32_t)d);
+}
+template <typename T>
+frac fraccrtDet(const T* a, int32_t n, int32_t threads = 1) {
+    int128_t num, den;
+    if (!fraccrtDet(a, n, num, den, threads)) {
+        return frac();
+    }
+    return fraccrtFrac(num, den);
+}
+template <typename T>
+bool fraccrtSolve(const T* a, const T* b, int32_t n, frac* x, int32_t threads = 1) {
+    std::vector<int128_t> num(n), den(n);
+    if (!fraccrtSolve(a, b, n, num.data(), den.data(), threads)) {
+        return false;
+    }
+    for (int32_t i = 0; i < n; i++) {
+        x[i] = fraccrtFrac(num[i], den[i]);
+    }
+    return true;
+}
+template <typename T>
+frac fraccrtDot(const T* a, const T* b, size_t n, int32_t threads = 1) {
+    int128_t num, den;
+    if (!fraccrtDot(a, b, n, num, den, threads)) {
+        return frac();
+    }
+    return fraccrtFrac(num, den);
+}
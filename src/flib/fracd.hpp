@@ -0,0 +1,426 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include "flib.hpp"
+#include "pow10.hpp"
+
+// fracd {n, p} = n * 10^p
+// decimal fixed point: fract's power of ten representation with the denominator fixed at 1,
+// so it is never stored and arithmetic never needs a GCD.
+// + and - align the exponents with one table multiply, * is exact,
+// division and rescaling round to a chosen power of ten with an explicit rounding mode.
+// the scale is kept (1.50 stays 150*10^-2), call normalize() to strip trailing zeros.
+// the numerator is 64 bits because without a denominator there is room, and money totals outgrow 32 bits.
+
+enum fracd_round {
+    FRACD_ROUND_DOWN, // toward zero
+    FRACD_ROUND_UP, // away from zero
+    FRACD_ROUND_FLOOR, // toward -infinity
+    FRACD_ROUND_CEIL, // toward +infinity
+    FRACD_ROUND_HALF_UP, // nearest, ties away from zero
+    FRACD_ROUND_HALF_EVEN // nearest, ties to even (banker's rounding)
+};
+
+// power used when a fraction with no exact decimal form is converted without an explicit power
+#define FRACD_DEFAULT_POWER -9
+
+class fracd {
+private:
+    int64_t num; // numerator
+    int8_t power; // power of 10 frac = num * 10^power
+
+    static __int128 divRound(__int128 n, __int128 d, fracd_round mode) {
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        __int128 q = n / d;
+        __int128 r = n % d;
+        if (r == 0) {
+            return q;
+        }
+        int32_t sign = n < 0 ? -1 : 1;
+        __int128 r2 = r < 0 ? -2 * r : 2 * r;
+        switch (mode) {
+            case FRACD_ROUND_DOWN:
+                return q;
+            case FRACD_ROUND_UP:
+                return q + sign;
+            case FRACD_ROUND_FLOOR:
+                return n < 0 ? q - 1 : q;
+            case FRACD_ROUND_CEIL:
+                return n > 0 ? q + 1 : q;
+            case FRACD_ROUND_HALF_UP:
+                return r2 >= d ? q + sign : q;
+            case FRACD_ROUND_HALF_EVEN:
+                return (r2 > d || (r2 == d && (q & 1))) ? q + sign : q;
+        }
+        return q;
+    }
+
+    // (n / d) * 10^p rounded to a multiple of 10^to, |n| and |d| must fit in 64 bits
+    static fracd quotient(__int128 n, __int128 d, int32_t p, int32_t to, fracd_round mode) {
+        fracd r;
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            return r;
+        }
+        // scale by up to 10^38 as long as it fits in 128 bits, small numerators leave room for more than 10^19
+        int32_t e = p - to;
+        __int128 t;
+        if (e > 38 || (e >= 0 && __builtin_mul_overflow(n, flib_pow10_128(e), &t))) {
+            if (n != 0) {
+                printf("Warning: fracd overflow.\n");
+            }
+            return r;
+        }
+        if (e >= 0) {
+            n = t;
+        } else if (e >= -38 && !__builtin_mul_overflow(d, flib_pow10_128(-e), &t)) {
+            d = t;
+        } else {
+            // |n / d| is far below 1/2, any d this large rounds the same way
+            d = d < 0 ? -((__int128)1 << 126) : ((__int128)1 << 126);
+        }
+        __int128 q = divRound(n, d, mode);
+        if (q > INT64_MAX || q < -INT64_MAX) {
+            printf("Warning: fracd overflow.\n");
+            return r;
+        }
+        r.num = q;
+        r.power = to;
+        return r;
+    }
+
+    // aligns both numerators to the smaller exponent, false if that overflows
+    static bool align(fracd a, fracd b, int64_t& x, int64_t& y, int8_t& p) {
+        p = a.power < b.power ? a.power : b.power;
+        if (a.num == 0) {
+            p = b.power;
+        } else if (b.num == 0) {
+            p = a.power;
+        }
+        x = a.num;
+        y = b.num;
+        return flib_scale10(x, a.power - p) && flib_scale10(y, b.power - p);
+    }
+
+    // -1, 0 or 1 as *this is less than, equal to or greater than f
+    int32_t cmp(fracd f) {
+        return flib_cmp10(num, power, f.num, f.power);
+    }
+
+public:
+    fracd(int64_t n, int8_t p) {
+        num = n;
+        power = p;
+    }
+    fracd(int64_t n) {
+        num = n;
+        power = 0;
+    }
+    fracd(int32_t n) {
+        num = n;
+        power = 0;
+    }
+    fracd() {
+        num = 0;
+        power = 0;
+    }
+    fracd(float f) {
+        num = llround((double)f * 1000000);
+        power = -6;
+        normalize();
+    }
+    fracd(double d) {
+        num = llround(d * 1000000);
+        power = -6;
+        normalize();
+    }
+    fracd(const char* s) {
+        num = 0;
+        power = 0;
+        if (parse(s, s + strlen(s), *this) == NULL) {
+            printf("Warning: \"%s\" is not a decimal number.\n", s);
+        }
+    }
+    // exact if the denominator only has factors 2 and 5, otherwise rounded half even to 10^FRACD_DEFAULT_POWER
+    fracd(fract f) {
+        *this = fromFraction(f.getNum(), f.getDen(), f.getPower());
+    }
+    fracd(frac f) {
+        *this = fromFraction(f.getNum(), f.getDen(), 0);
+    }
+    // rounded to a multiple of 10^p
+    fracd(fract f, int8_t p, fracd_round mode) {
+        *this = quotient(f.getNum(), f.getDen(), f.getPower(), p, mode);
+    }
+    fracd(frac f, int8_t p, fracd_round mode) {
+        *this = quotient(f.getNum(), f.getDen(), 0, p, mode);
+    }
+
+    static fracd fromFraction(int32_t n, int32_t d, int8_t p) {
+        // n / d terminates iff d = 2^a * 5^b, then n / d = n * 2^(k-a) * 5^(k-b) / 10^k with k = max(a, b)
+        int32_t a = 0;
+        int32_t b = 0;
+        int32_t r = d < 0 ? -d : d;
+        while (r != 0 && (r & 1) == 0) {
+            r >>= 1;
+            a++;
+        }
+        while (r != 0 && r % 5 == 0) {
+            r /= 5;
+            b++;
+        }
+        if (r == 1) {
+            return quotient(n, d, p, p - (a > b ? a : b), FRACD_ROUND_HALF_EVEN);
+        }
+        return quotient(n, d, p, FRACD_DEFAULT_POWER, FRACD_ROUND_HALF_EVEN);
+    }
+
+    // parses [+-]digits[.digits][e[+-]digits] from [s, end), returns the end of the number or NULL
+    // a number that does not fit also returns NULL, and sets *overflow so callers can tell it from text
+    static const char* parse(const char* s, const char* end, fracd& r, bool* overflow = NULL) {
+        const char* c = s;
+        bool neg = false;
+        if (c < end && (*c == '-' || *c == '+')) {
+            neg = *c == '-';
+            c++;
+        }
+        uint64_t n = 0;
+        int32_t p = 0;
+        int32_t digits = 0;
+        bool point = false;
+        for (; c < end; c++) {
+            if (*c == '.' && !point) {
+                point = true;
+                continue;
+            }
+            if (*c < '0' || *c > '9') {
+                break;
+            }
+            digits++;
+            if (n <= (uint64_t)(INT64_MAX - 9) / 10) {
+                n = n * 10 + (*c - '0');
+                p -= point;
+            } else if (*c != '0') {
+                printf("Warning: fracd overflow.\n");
+                if (overflow != NULL) {
+                    *overflow = true;
+                }
+                return NULL;
+            } else if (!point) {
+                p++;
+            }
+        }
+        if (digits == 0) {
+            return NULL;
+        }
+        if (c < end && (*c == 'e' || *c == 'E')) {
+            const char* e = c + 1;
+            bool eneg = false;
+            if (e < end && (*e == '-' || *e == '+')) {
+                eneg = *e == '-';
+                e++;
+            }
+            int32_t x = 0;
+            const char* start = e;
+            for (; e < end && *e >= '0' && *e <= '9' && x < 1000; e++) {
+                x = x * 10 + (*e - '0');
+            }
+            if (e != start) {
+                p += eneg ? -x : x;
+                c = e;
+            }
+        }
+        if (p > INT8_MAX || p < INT8_MIN) {
+            if (n == 0) {
+                p = 0;
+            } else {
+                printf("Warning: fracd overflow.\n");
+                if (overflow != NULL) {
+                    *overflow = true;
+                }
+                return NULL;
+            }
+        }
+        r.num = neg ? -(int64_t)n : (int64_t)n;
+        r.power = p;
+        return c;
+    }
+
+    fracd normalize() {
+        if (num == 0) {
+            power = 0;
+            return *this;
+        }
+        int64_t n = num;
+        int32_t z = flib_strip10(n);
+        if (power + z > INT8_MAX) {
+            return *this;
+        }
+        num = n;
+        power += z;
+        return *this;
+    }
+    // rounded to a multiple of 10^p
+    fracd rescale(int8_t p, fracd_round mode) {
+        return quotient(num, 1, power, p, mode);
+    }
+    // *this / f rounded to a multiple of 10^p
+    fracd div(fracd f, int8_t p, fracd_round mode) {
+        return quotient(num, f.num, power - f.power, p, mode);
+    }
+
+    int64_t getNum() {
+        return num;
+    }
+    int8_t getPower() {
+        return power;
+    }
+
+    fracd operator+(fracd f) {
+        fracd r;
+        int64_t a, b;
+        if (!align(*this, f, a, b, r.power) || __builtin_add_overflow(a, b, &r.num)) {
+            printf("Warning: fracd overflow.\n");
+            return fracd();
+        }
+        return r;
+    }
+    fracd operator-(fracd f) {
+        fracd r;
+        int64_t a, b;
+        if (!align(*this, f, a, b, r.power) || __builtin_sub_overflow(a, b, &r.num)) {
+            printf("Warning: fracd overflow.\n");
+            return fracd();
+        }
+        return r;
+    }
+    fracd operator*(fracd f) {
+        fracd r;
+        int32_t p = power + f.power;
+        if (__builtin_mul_overflow(num, f.num, &r.num) || p > INT8_MAX || p < INT8_MIN) {
+            printf("Warning: fracd overflow.\n");
+            return fracd();
+        }
+        r.power = r.num == 0 ? 0 : p;
+        return r;
+    }
+    fracd operator+=(fracd f) {
+        *this = *this + f;
+        return *this;
+    }
+    fracd operator-=(fracd f) {
+        *this = *this - f;
+        return *this;
+    }
+    fracd operator*=(fracd f) {
+        *this = *this * f;
+        return *this;
+    }
+    fracd operator-() {
+        return fracd(-num, power);
+    }
+    fracd operator+() {
+        return *this;
+    }
+    bool operator==(fracd f) {
+        return cmp(f) == 0;
+    }
+    bool operator!=(fracd f) {
+        return cmp(f) != 0;
+    }
+    bool operator>(fracd f) {
+        return cmp(f) > 0;
+    }
+    bool operator<(fracd f) {
+        return cmp(f) < 0;
+    }
+    bool operator>=(fracd f) {
+        return cmp(f) >= 0;
+    }
+    bool operator<=(fracd f) {
+        return cmp(f) <= 0;
+    }
+
+    operator fract() {
+        fracd r = *this;
+        r.normalize();
+        if (r.num > INT32_MAX || r.num < -INT32_MAX) {
+            printf("Warning: value does not fit in fract.\n");
+        }
+        return fract((int32_t)r.num, 1, r.power);
+    }
+    operator frac() {
+        fracd r = *this;
+        r.normalize();
+        if (r.num > INT32_MAX || r.num < -INT32_MAX || r.power > 9 || r.power < -9 ||
+            (r.power > 0 && (r.num > INT32_MAX / flib_pow10[r.power] || r.num < -INT32_MAX / flib_pow10[r.power]))) {
+            printf("Warning: value does not fit in frac.\n");
+        }
+        if (r.power < 0) {
+            return frac((int32_t)r.num, (int32_t)flib_pow10[-r.power < 9 ? -r.power : 9]);
+        }
+        return frac((int32_t)(r.num * flib_pow10[r.power < 9 ? r.power : 9]));
+    }
+    operator float() {
+        return (float)(double)*this;
+    }
+    operator double() {
+        if (power < 0) {
+            return (double)num / pow(10, -power);
+        }
+        return (double)num * pow(10, power);
+    }
+
+    // writes the exact decimal form, returns the length like snprintf
+    int decString(char* buf, size_t n) {
+        char digits[24];
+        char out[160];
+        int32_t len = snprintf(digits, sizeof(digits), "%llu", (unsigned long long)(num < 0 ? -(uint64_t)num : (uint64_t)num));
+        int32_t i = 0;
+        if (num < 0) {
+            out[i++] = '-';
+        }
+        if (power >= 0) {
+            for (int32_t j = 0; j < len; j++) {
+                out[i++] = digits[j];
+            }
+            for (int32_t j = 0; j < power && num != 0; j++) {
+                out[i++] = '0';
+            }
+        } else {
+            int32_t point = len + power; // digits before the point
+            if (point <= 0) {
+                out[i++] = '0';
+                out[i++] = '.';
+                for (int32_t j = point; j < 0; j++) {
+                    out[i++] = '0';
+                }
+                for (int32_t j = 0; j < len; j++) {
+                    out[i++] = digits[j];
+                }
+            } else {
+                for (int32_t j = 0; j < len; j++) {
+                    if (j == point) {
+                        out[i++] = '.';
+                    }
+                    out[i++] = digits[j];
+                }
+            }
+        }
+        out[i] = 0;
+        return snprintf(buf, n, "%s", out);
+    }
+    void frcPrint() {
+        printf("%lld*10^%d\n", (long long)num, power);
+    }
+    void decPrint() {
+        char buf[160];
+        decString(buf, sizeof(buf));
+        printf("%s\n", buf);
+    }
+};
@@ -0,0 +1,179 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include "flib.hpp"
+
+// frac_scaler, frac_divisor: multiply or divide many fracs by the same value
+// frac's * and / multiply out and run a full GCD against the operand every time.
+// these factor the operand a / b once into prime powers, and for each odd prime keep its inverse mod 2^32:
+// x * inverse(p) <= UINT32_MAX / p exactly when p divides x, and then x * inverse(p) is x / p.
+// applying to n / d (already reduced) only has to cancel b's primes from n and a's primes from d,
+// with a multiply and a compare per step (a shift for 2), and the result is in lowest terms without a GCD.
+// results that do not fit in 32 bits print a warning like frac does for a zero denominator.
+
+class frac_scaler {
+private:
+    struct factor {
+        uint32_t p; // odd prime
+        uint32_t inv; // p^-1 mod 2^32
+        uint32_t lim; // UINT32_MAX / p
+        int32_t e; // exponent
+    };
+
+    struct factors {
+        int32_t twos; // exponent of 2
+        int32_t count;
+        factor f[10]; // a 32-bit number has at most 9 distinct odd primes
+    };
+
+    uint32_t num; // |a|
+    uint32_t den; // b
+    int32_t sign; // sign of a
+    factors fn; // factors of a
+    factors fd; // factors of b
+
+    static void factorize(uint32_t x, factors& r) {
+        r.count = 0;
+        r.twos = 0;
+        if (x == 0) {
+            return;
+        }
+        r.twos = __builtin_ctz(x);
+        x >>= r.twos;
+        for (uint32_t p = 3; x > 1; p += 2) {
+            if ((uint64_t)p * p > x) {
+                p = x;
+            }
+            if (x % p != 0) {
+                continue;
+            }
+            factor& f = r.f[r.count++];
+            f.p = p;
+            f.lim = UINT32_MAX / p;
+            f.e = 0;
+            // newton's iteration doubles the correct low bits of the inverse each step
+            uint32_t inv = p;
+            for (int32_t i = 0; i < 4; i++) {
+                inv *= 2 - p * inv;
+            }
+            f.inv = inv;
+            while (x % p == 0) {
+                x /= p;
+                f.e++;
+            }
+        }
+    }
+
+    // divides x and y by the common part of x and fs (y is a multiple of that whole number)
+    static void cancel(uint32_t& x, uint32_t& y, const factors& fs) {
+        if (fs.twos != 0) {
+            int32_t z = x == 0 ? 0 : __builtin_ctz(x);
+            z = z < fs.twos ? z : fs.twos;
+            x >>= z;
+            y >>= z;
+        }
+        for (int32_t i = 0; i < fs.count; i++) {
+            const factor& f = fs.f[i];
+            for (int32_t k = 0; k < f.e; k++) {
+                uint32_t t = x * f.inv;
+                if (t > f.lim) {
+                    break;
+                }
+                x = t;
+                y *= f.inv;
+            }
+        }
+    }
+
+public:
+    frac_scaler(frac s) {
+        int32_t a = s.getNum();
+        int32_t b = s.getDen();
+        sign = a < 0 ? -1 : 1;
+        num = a < 0 ? -(uint32_t)a : a;
+        den = b;
+        factorize(num, fn);
+        factorize(den, fd);
+    }
+    frac_scaler(int32_t n, int32_t d) : frac_scaler(frac(n, d)) {}
+
+    frac getValue() {
+        return frac::raw(sign * (int32_t)num, den);
+    }
+
+    // x * a / b, reduced
+    frac apply(frac x) {
+        int32_t xn = x.getNum();
+        uint32_t n = xn < 0 ? -(uint32_t)xn : xn;
+        uint32_t d = x.getDen();
+        if (n == 0 || num == 0) {
+            return frac();
+        }
+        uint32_t a = num;
+        uint32_t b = den;
+        cancel(n, b, fd); // gcd(n, b)
+        cancel(d, a, fn); // gcd(d, a)
+        uint64_t rn = (uint64_t)n * a;
+        uint64_t rd = (uint64_t)d * b;
+        if (rn > INT32_MAX || rd > INT32_MAX) {
+            printf("Warning: result does not fit in frac.\n");
+            return frac();
+        }
+        int32_t s = xn < 0 ? -sign : sign;
+        return frac::raw(s * (int32_t)rn, (int32_t)rd);
+    }
+    frac operator()(frac x) {
+        return apply(x);
+    }
+    // every x[i] in place
+    void apply(frac* x, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            x[i] = apply(x[i]);
+        }
+    }
+    void apply(const frac* in, frac* out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = apply(in[i]);
+        }
+    }
+};
+
+// x / v is x * (1 / v), so a divisor is a scaler by the reciprocal
+class frac_divisor {
+private:
+    frac_scaler s;
+
+    static frac reciprocal(frac v) {
+        if (v.getNum() == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            return frac();
+        }
+        return v.getNum() < 0 ? frac::raw(-v.getDen(), -v.getNum()) : frac::raw(v.getDen(), v.getNum());
+    }
+
+public:
+    frac_divisor(frac v) : s(reciprocal(v)) {}
+    frac_divisor(int32_t n, int32_t d) : frac_divisor(frac(n, d)) {}
+
+    // x / v, reduced
+    frac apply(frac x) {
+        return s.apply(x);
+    }
+    frac operator()(frac x) {
+        return s.apply(x);
+    }
+    void apply(frac* x, size_t n) {
+        s.apply(x, n);
+    }
+    void apply(const frac* in, frac* out, size_t n) {
+        s.apply(in, out, n);
+    }
+};
+
+static inline frac operator*(frac x, frac_scaler& s) {
+    return s.apply(x);
+}
+static inline frac operator/(frac x, frac_divisor& d) {
+    return d.apply(x);
+}
@@ -0,0 +1,219 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+#include "flib.hpp"
+#include "int128.hpp"
+
+// binary splitting summation of long series
+//
+// fracsum:    sum of p(k) / q(k) for k in [a, b)                      (harmonic numbers, sums of independent terms)
+// fracseries: sum of p(a)...p(k) / (q(a)...q(k)) for k in [a, b)       (Taylor series, given the ratio of consecutive terms)
+//
+// term(k, p, q) sets p and q for index k. instead of adding terms one at a time into a running sum
+// (which grows the numbers with every add), terms are combined pairwise in a balanced tree,
+// so both halves of every combine are about the same size, and the result is reduced once at the end.
+// I is the integer type of the tree: int64_t, int128_t or any integer type with + - * / % and comparisons.
+// fixed width types overflow quickly on an unreduced tree (the denominator is the product of every q),
+// so with them pass reduce = true to also reduce each node, which keeps the tree balanced but adds a gcd per node.
+// the top levels of the tree run on up to `threads` threads. every thread started gets its own copy of term
+// and only calls that copy, so a term with state (a memo table, a counter) never races, but the copies do not
+// share it: state that has to be shared between threads must be made thread safe by term itself.
+// with int32_t, int64_t and int128_t every product and sum is overflow checked, and the sums return false
+// (printing a warning) when a node does not fit, other types are trusted to be wide enough.
+
+template <typename I>
+I fracsumGcd(I a, I b) {
+    I c;
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (a != 0) {
+        c = a;
+        a = b % a;
+        b = c;
+    }
+    return b;
+}
+
+// r = a * b and r = a + b, false on overflow
+template <typename I>
+bool fracsumMul(I a, I b, I& r) {
+    r = a * b;
+    return true;
+}
+template <typename I>
+bool fracsumAdd(I a, I b, I& r) {
+    r = a + b;
+    return true;
+}
+static inline bool fracsumMul(int32_t a, int32_t b, int32_t& r) {
+    return !__builtin_mul_overflow(a, b, &r);
+}
+static inline bool fracsumAdd(int32_t a, int32_t b, int32_t& r) {
+    return !__builtin_add_overflow(a, b, &r);
+}
+static inline bool fracsumMul(int64_t a, int64_t b, int64_t& r) {
+    return !__builtin_mul_overflow(a, b, &r);
+}
+static inline bool fracsumAdd(int64_t a, int64_t b, int64_t& r) {
+    return !__builtin_add_overflow(a, b, &r);
+}
+static inline bool fracsumMul(int128_t a, int128_t b, int128_t& r) {
+    return !__builtin_mul_overflow(a, b, &r);
+}
+static inline bool fracsumAdd(int128_t a, int128_t b, int128_t& r) {
+    return !__builtin_add_overflow(a, b, &r);
+}
+
+template <typename I>
+void fracsumReduce(I& n, I& d) {
+    I g = fracsumGcd(n, d);
+    if (g != 0 && g != 1) {
+        n /= g;
+        d /= g;
+    }
+    if (d < 0) {
+        n = -n;
+        d = -d;
+    }
+}
+
+// terms [a, b) as p / q, false on overflow
+template <typename I, typename T>
+bool fracsumSplit(T& term, int64_t a, int64_t b, I& p, I& q, int32_t threads, bool reduce) {
+    if (b - a == 1) {
+        term(a, p, q);
+        return true;
+    }
+    int64_t m = a + (b - a) / 2;
+    I lp, lq, rp, rq;
+    bool lok, rok;
+    if (threads > 1) {
+        // the new thread gets its own copy of term, this one keeps using the caller's
+        T lt = term;
+        std::thread left([&]() { lok = fracsumSplit(lt, a, m, lp, lq, threads / 2, reduce); });
+        rok = fracsumSplit(term, m, b, rp, rq, threads - threads / 2, reduce);
+        left.join();
+    } else {
+        lok = fracsumSplit(term, a, m, lp, lq, 1, reduce);
+        rok = fracsumSplit(term, m, b, rp, rq, 1, reduce);
+    }
+    if (!lok || !rok) {
+        return false;
+    }
+    // divide out the common part of the denominators first so the products stay small
+    I g = reduce ? fracsumGcd(lq, rq) : I(1);
+    I x, y;
+    if (!fracsumMul(lp, rq / g, x) || !fracsumMul(rp, lq / g, y) || !fracsumAdd(x, y, p) ||
+        !fracsumMul(lq / g, rq, q)) {
+        return false;
+    }
+    if (reduce) {
+        fracsumReduce(p, q);
+    }
+    return true;
+}
+
+// ratios [a, b) as P = p(a)...p(b-1), Q = q(a)...q(b-1) and the partial sum S / Q, false on overflow
+template <typename I, typename T>
+bool fracseriesSplit(T& term, int64_t a, int64_t b, I& P, I& Q, I& S, int32_t threads, bool reduce) {
+    if (b - a == 1) {
+        term(a, P, Q);
+        S = P;
+        return true;
+    }
+    int64_t m = a + (b - a) / 2;
+    I lP, lQ, lS, rP, rQ, rS;
+    bool lok, rok;
+    if (threads > 1) {
+        T lt = term;
+        std::thread left([&]() { lok = fracseriesSplit(lt, a, m, lP, lQ, lS, threads / 2, reduce); });
+        rok = fracseriesSplit(term, m, b, rP, rQ, rS, threads - threads / 2, reduce);
+        left.join();
+    } else {
+        lok = fracseriesSplit(term, a, m, lP, lQ, lS, 1, reduce);
+        rok = fracseriesSplit(term, m, b, rP, rQ, rS, 1, reduce);
+    }
+    if (!lok || !rok) {
+        return false;
+    }
+    // S/Q = lS/lQ + (lP/lQ) * (rS/rQ)
+    I x, y;
+    if (!fracsumMul(lP, rP, P) || !fracsumMul(lQ, rQ, Q) || !fracsumMul(lS, rQ, x) || !fracsumMul(lP, rS, y) ||
+        !fracsumAdd(x, y, S)) {
+        return false;
+    }
+    if (reduce) {
+        // P/Q and S/Q must keep the same denominator, so only common factors of all three are removed
+        I g = fracsumGcd(fracsumGcd(P, Q), S);
+        if (g != 0 && g != 1) {
+            P /= g;
+            Q /= g;
+            S /= g;
+        }
+    }
+    return true;
+}
+
+// num / den = sum of p(k) / q(k) for k in [a, b), reduced, false (and 0 / 1) if a node overflows
+template <typename I, typename T>
+bool fracsum(T term, int64_t a, int64_t b, I& num, I& den, int32_t threads = 1, bool reduce = false) {
+    num = 0;
+    den = 1;
+    if (b <= a) {
+        return true;
+    }
+    if (!fracsumSplit(term, a, b, num, den, threads < 1 ? 1 : threads, reduce)) {
+        printf("Warning: fracsum overflow.\n");
+        num = 0;
+        den = 1;
+        return false;
+    }
+    fracsumReduce(num, den);
+    return true;
+}
+
+// num / den = sum over k in [a, b) of p(a)...p(k) / (q(a)...q(k)), reduced, false (and 0 / 1) if a node overflows
+template <typename I, typename T>
+bool fracseries(T term, int64_t a, int64_t b, I& num, I& den, int32_t threads = 1, bool reduce = false) {
+    num = 0;
+    den = 1;
+    if (b <= a) {
+        return true;
+    }
+    I P;
+    if (!fracseriesSplit(term, a, b, P, den, num, threads < 1 ? 1 : threads, reduce)) {
+        printf("Warning: fracseries overflow.\n");
+        num = 0;
+        den = 1;
+        return false;
+    }
+    fracsumReduce(num, den);
+    return true;
+}
+
+// the same sums as a frac, with a warning if the result does not fit
+template <typename T>
+frac fracsum(T term, int64_t a, int64_t b, int32_t threads = 1) {
+    int128_t n, d;
+    if (!fracsum(term, a, b, n, d, threads, true)) {
+        return frac();
+    }
+    if (n > INT32_MAX || n < -INT32_MAX || d > INT32_MAX) {
+        printf("Warning: sum does not fit in frac.\n");
+        return frac();
+    }
+    return frac((int32_t)n, (int32_t)d);
+}
+template <typename T>
+frac fracseries(T term, int64_t a, int64_t b, int32_t threads = 1) {
+    int128_t n, d;
+    if (!fracseries(term, a, b, n, d, threads, true)) {
+        return frac();
+    }
+    if (n > INT32_MAX || n < -INT32_MAX || d > INT32_MAX) {
+        printf("Warning: sum does not fit in frac.\n");
+        return frac();
+    }
+    return frac((int32_t)n, (int32_t)d);
+}
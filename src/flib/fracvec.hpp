@@ -0,0 +1,326 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include "flib.hpp"
+#include "pow10.hpp"
+
+// fracvec: an array of fractions that share denominators
+// elements are grouped in blocks of FRACVEC_BLOCK, each block stores one denominator (the lcm of its elements')
+// and every element only stores its numerator over it, so an element takes 4 bytes instead of frac's 8.
+// element-wise + and - bring both blocks to a common denominator once and then are plain integer loops
+// the compiler can vectorize, and scaling by a fraction changes the block denominator and multiplies numerators once.
+// blocks are not reduced after every op, only when a result would not fit in 32 bits (or on reduce()),
+// so get() returns the reduced frac but getNum() and getDen() are the raw stored values.
+// results that do not fit even after reducing print a warning like frac does for a zero denominator.
+
+#define FRACVEC_BLOCK 256
+
+class fracvec {
+private:
+    std::vector<int32_t> num; // numerators, element i is num[i] / den[i / FRACVEC_BLOCK]
+    std::vector<int32_t> den; // one denominator per block, always > 0
+
+    static int64_t gcd(int64_t a, int64_t b) {
+        int64_t c;
+        a = a < 0 ? -a : a;
+        b = b < 0 ? -b : b;
+        while (a != 0) {
+            c = a;
+            a = b % a;
+            b = c;
+        }
+        return b;
+    }
+
+    size_t blockStart(size_t b) const {
+        return b * FRACVEC_BLOCK;
+    }
+    size_t blockEnd(size_t b) const {
+        size_t e = (b + 1) * FRACVEC_BLOCK;
+        return e < num.size() ? e : num.size();
+    }
+
+    void overflow() {
+        printf("Warning: fracvec overflow, block does not fit in 32 bits.\n");
+    }
+
+    // stores numerators t over d (> 0) into block b, reducing the block only if it does not fit
+    void store(size_t b, int64_t* t, int64_t d) {
+        size_t s = blockStart(b);
+        size_t n = blockEnd(b) - s;
+        int64_t lo = 0;
+        int64_t hi = 0;
+        for (size_t i = 0; i < n; i++) {
+            lo = t[i] < lo ? t[i] : lo;
+            hi = t[i] > hi ? t[i] : hi;
+        }
+        if (d > INT32_MAX || hi > INT32_MAX || lo < -INT32_MAX) {
+            int64_t g = d;
+            for (size_t i = 0; i < n && g != 1; i++) {
+                g = gcd(t[i], g);
+            }
+            for (size_t i = 0; i < n; i++) {
+                t[i] /= g;
+            }
+            d /= g;
+            hi /= g;
+            lo /= g;
+            if (d > INT32_MAX || hi > INT32_MAX || lo < -INT32_MAX) {
+                overflow();
+                return;
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            num[s + i] = (int32_t)t[i];
+        }
+        den[b] = (int32_t)d;
+    }
+
+    // block b as n / d reduced fractions, d > 0
+    void load(size_t b, int64_t* n, int64_t* d) {
+        size_t s = blockStart(b);
+        size_t k = blockEnd(b) - s;
+        int64_t l = 1;
+        for (size_t i = 0; i < k; i++) {
+            if (d[i] == 0) {
+                printf("Warning: denominator is 0, answer is undefined.\n");
+                n[i] = 0;
+                d[i] = 1;
+            }
+            if (d[i] < 0) {
+                n[i] = -n[i];
+                d[i] = -d[i];
+            }
+            int64_t g = gcd(n[i], d[i]);
+            n[i] /= g;
+            d[i] /= g;
+            l = l / gcd(l, d[i]) * d[i];
+            if (l > INT32_MAX || n[i] > INT32_MAX || n[i] < -INT32_MAX) {
+                overflow();
+                return;
+            }
+        }
+        for (size_t i = 0; i < k; i++) {
+            n[i] *= l / d[i];
+        }
+        store(b, n, l);
+    }
+
+    // this[i] = this[i] + sign * f[i]
+    void add(const fracvec& f, int64_t sign) {
+        if (f.num.size() != num.size()) {
+            printf("Warning: fracvec sizes differ.\n");
+            return;
+        }
+        int64_t t[FRACVEC_BLOCK];
+        for (size_t b = 0; b < den.size(); b++) {
+            size_t s = blockStart(b);
+            size_t n = blockEnd(b) - s;
+            int64_t g = gcd(den[b], f.den[b]);
+            int64_t m1 = f.den[b] / g;
+            int64_t m2 = den[b] / g * sign;
+            const int32_t* x = &num[s];
+            const int32_t* y = &f.num[s];
+            for (size_t i = 0; i < n; i++) {
+                t[i] = x[i] * m1 + y[i] * m2;
+            }
+            store(b, t, (int64_t)den[b] * m1);
+        }
+    }
+
+    // every element times n / d
+    void scale(int64_t n, int64_t d) {
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            return;
+        }
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        int64_t t[FRACVEC_BLOCK];
+        for (size_t b = 0; b < den.size(); b++) {
+            size_t s = blockStart(b);
+            size_t k = blockEnd(b) - s;
+            // cancel n against the block denominator, so n == 1 only touches the denominator
+            int64_t g = gcd(n, den[b]);
+            int64_t m = n / g;
+            int64_t e = den[b] / g * d;
+            if (m == 1 && e <= INT32_MAX) {
+                den[b] = (int32_t)e;
+                continue;
+            }
+            for (size_t i = 0; i < k; i++) {
+                t[i] = num[s + i] * m;
+            }
+            store(b, t, e);
+        }
+    }
+
+public:
+    fracvec() {}
+    // n zeros
+    fracvec(size_t n) {
+        num.assign(n, 0);
+        den.assign((n + FRACVEC_BLOCK - 1) / FRACVEC_BLOCK, 1);
+    }
+    fracvec(const frac* a, size_t n) : fracvec(n) {
+        int64_t tn[FRACVEC_BLOCK];
+        int64_t td[FRACVEC_BLOCK];
+        for (size_t b = 0; b < den.size(); b++) {
+            for (size_t i = blockStart(b); i < blockEnd(b); i++) {
+                frac f = a[i];
+                tn[i - blockStart(b)] = f.getNum();
+                td[i - blockStart(b)] = f.getDen();
+            }
+            load(b, tn, td);
+        }
+    }
+    fracvec(const fract* a, size_t n) : fracvec(n) {
+        int64_t tn[FRACVEC_BLOCK];
+        int64_t td[FRACVEC_BLOCK];
+        for (size_t b = 0; b < den.size(); b++) {
+            for (size_t i = blockStart(b); i < blockEnd(b); i++) {
+                fract f = a[i];
+                int64_t x = f.getNum();
+                int64_t y = f.getDen();
+                int32_t p = f.getPower();
+                if (!flib_scale10(p > 0 ? x : y, p > 0 ? p : -p)) {
+                    overflow();
+                    x = 0;
+                    y = 1;
+                }
+                tn[i - blockStart(b)] = x;
+                td[i - blockStart(b)] = y;
+            }
+            load(b, tn, td);
+        }
+    }
+
+    size_t size() const {
+        return num.size();
+    }
+    size_t blocks() const {
+        return den.size();
+    }
+    // raw numerator of element i over getDen(i), not reduced
+    int32_t getNum(size_t i) const {
+        return num[i];
+    }
+    // raw denominator shared by element i's block
+    int32_t getDen(size_t i) const {
+        return den[i / FRACVEC_BLOCK];
+    }
+    // element i, reduced
+    frac get(size_t i) const {
+        return frac(num[i], den[i / FRACVEC_BLOCK]);
+    }
+    frac operator[](size_t i) const {
+        return get(i);
+    }
+    // sets element i, the rest of its block is brought to the new common denominator
+    void set(size_t i, frac f) {
+        size_t b = i / FRACVEC_BLOCK;
+        size_t s = blockStart(b);
+        size_t k = blockEnd(b) - s;
+        int64_t d = f.getDen();
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            return;
+        }
+        int64_t l = den[b] / gcd(den[b], d) * d;
+        int64_t m = l / den[b];
+        int64_t t[FRACVEC_BLOCK];
+        for (size_t j = 0; j < k; j++) {
+            t[j] = num[s + j] * m;
+        }
+        t[i - s] = f.getNum() * (l / d);
+        store(b, t, l);
+    }
+
+    // fully reduces every block, otherwise only done when a result would not fit
+    fracvec& reduce() {
+        for (size_t b = 0; b < den.size(); b++) {
+            size_t s = blockStart(b);
+            size_t e = blockEnd(b);
+            int64_t g = den[b];
+            for (size_t i = s; i < e && g != 1; i++) {
+                g = gcd(num[i], g);
+            }
+            if (g > 1) {
+                for (size_t i = s; i < e; i++) {
+                    num[i] /= g;
+                }
+                den[b] /= g;
+            }
+        }
+        return *this;
+    }
+
+    void toFrac(frac* out) const {
+        for (size_t i = 0; i < num.size(); i++) {
+            out[i] = get(i);
+        }
+    }
+    void toFract(fract* out) const {
+        for (size_t i = 0; i < num.size(); i++) {
+            out[i] = fract(num[i], den[i / FRACVEC_BLOCK]);
+        }
+    }
+
+    fracvec operator+(const fracvec& f) const {
+        fracvec r = *this;
+        r.add(f, 1);
+        return r;
+    }
+    fracvec operator-(const fracvec& f) const {
+        fracvec r = *this;
+        r.add(f, -1);
+        return r;
+    }
+    fracvec operator*(frac f) const {
+        fracvec r = *this;
+        r.scale(f.getNum(), f.getDen());
+        return r;
+    }
+    fracvec operator/(frac f) const {
+        fracvec r = *this;
+        r.scale(f.getDen(), f.getNum());
+        return r;
+    }
+    fracvec& operator+=(const fracvec& f) {
+        add(f, 1);
+        return *this;
+    }
+    fracvec& operator-=(const fracvec& f) {
+        add(f, -1);
+        return *this;
+    }
+    fracvec& operator*=(frac f) {
+        scale(f.getNum(), f.getDen());
+        return *this;
+    }
+    fracvec& operator/=(frac f) {
+        scale(f.getDen(), f.getNum());
+        return *this;
+    }
+    fracvec operator-() const {
+        fracvec r = *this;
+        for (size_t i = 0; i < r.num.size(); i++) {
+            r.num[i] = -r.num[i];
+        }
+        return r;
+    }
+
+    void frcPrint() {
+        for (size_t i = 0; i < num.size(); i++) {
+            get(i).frcPrint();
+        }
+    }
+    void decPrint() {
+        for (size_t i = 0; i < num.size(); i++) {
+            printf("%f\n", (double)num[i] / (double)den[i / FRACVEC_BLOCK]);
+        }
+    }
+};
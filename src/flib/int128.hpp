@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+// 128-bit integers (GCC and Clang), used where exact results outgrow 64 bits
+typedef __int128 int128_t;
+typedef unsigned __int128 uint128_t;
+
+static inline int128_t gcd128(int128_t a, int128_t b) {
+    int128_t c;
+    if (a < 0) {
+        a = -a;
+    }
+    if (b < 0) {
+        b = -b;
+    }
+    while (a != 0) {
+        c = a;
+        a = b % a;
+        b = c;
+    }
+    return b;
+}
+
+// writes n in decimal, buf needs 41 bytes
+static inline void sprint128(char* buf, int128_t n) {
+    char tmp[48];
+    int32_t i = 0;
+    uint128_t u = n < 0 ? -(uint128_t)n : (uint128_t)n;
+    do {
+        tmp[i++] = '0' + (int32_t)(u % 10);
+        u /= 10;
+    } while (u != 0);
+    if (n < 0) {
+        tmp[i++] = '-';
+    }
+    for (int32_t j = 0; j < i; j++) {
+        buf[j] = tmp[i - 1 - j];
+    }
+    buf[i] = 0;
+}
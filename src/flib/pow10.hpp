@@ -0,0 +1,176 @@
+#pragma once
+#include <cstdint>
+#include "int128.hpp"
+
+// decimal exponent normalization and alignment for fract, fracti and fracd
+// trailing zeros are counted without a divide per digit: x is divisible by 10^k exactly when
+// rotr(x * inverse(5^k), k) <= max / 10^k (the multiply divides out 5^k modulo 2^n, the rotate
+// moves the 2^k factor into the high bits unless it was there), and then that value is x / 10^k.
+// testing k = 8, 4, 2, 1 (and 16 for 64 bits) strips any count of zeros in a few multiplies.
+// exponents are aligned with one multiply from the table below.
+
+// powers of ten that fit in 64 bits
+static const int64_t flib_pow10[19] = {
+    1LL,
+    10LL,
+    100LL,
+    1000LL,
+    10000LL,
+    100000LL,
+    1000000LL,
+    10000000LL,
+    100000000LL,
+    1000000000LL,
+    10000000000LL,
+    100000000000LL,
+    1000000000000LL,
+    10000000000000LL,
+    100000000000000LL,
+    1000000000000000LL,
+    10000000000000000LL,
+    100000000000000000LL,
+    1000000000000000000LL,
+};
+
+// strips the trailing decimal zeros from x, returns how many there were (0 for x = 0)
+static inline int32_t flib_strip10(uint32_t& x) {
+    static const int32_t k[4] = {8, 4, 2, 1};
+    static const uint32_t inv[4] = {0x22e90e21u, 0x3afb7e91u, 0xc28f5c29u, 0xcccccccdu}; // 5^-k mod 2^32
+    static const uint32_t max[4] = {42u, 429496u, 42949672u, 429496729u}; // (2^32 - 1) / 10^k
+    int32_t z = 0;
+    if (x == 0) {
+        return 0;
+    }
+    for (int32_t i = 0; i < 4; i++) {
+        uint32_t q = x * inv[i];
+        q = (q >> k[i]) | (q << (32 - k[i]));
+        if (q <= max[i]) {
+            x = q;
+            z += k[i];
+        }
+    }
+    return z;
+}
+
+static inline int32_t flib_strip10(uint64_t& x) {
+    static const int32_t k[5] = {16, 8, 4, 2, 1};
+    static const uint64_t inv[5] = {0xe4a4d1417cd9a041ull, 0xc767074b22e90e21ull, 0xd288ce703afb7e91ull,
+                                    0x8f5c28f5c28f5c29ull, 0xcccccccccccccccdull}; // 5^-k mod 2^64
+    static const uint64_t max[5] = {1844ull, 184467440737ull, 1844674407370955ull, 184467440737095516ull,
+                                    1844674407370955161ull}; // (2^64 - 1) / 10^k
+    int32_t z = 0;
+    if (x == 0) {
+        return 0;
+    }
+    for (int32_t i = 0; i < 5; i++) {
+        uint64_t q = x * inv[i];
+        q = (q >> k[i]) | (q << (64 - k[i]));
+        if (q <= max[i]) {
+            x = q;
+            z += k[i];
+        }
+    }
+    return z;
+}
+
+// strips the trailing decimal zeros from a signed x, returns how many there were
+static inline int32_t flib_strip10(int64_t& x) {
+    uint64_t u = x < 0 ? -(uint64_t)x : (uint64_t)x;
+    int32_t z = flib_strip10(u);
+    x = x < 0 ? -(int64_t)u : (int64_t)u;
+    return z;
+}
+
+// 10^p for 0 <= p <= 38
+static inline int128_t flib_pow10_128(int32_t p) {
+    int128_t r = 1;
+    while (p > 18) {
+        r *= flib_pow10[18];
+        p -= 18;
+    }
+    return r * flib_pow10[p];
+}
+
+// x * 10^e for e >= 0, false if that overflows
+static inline bool flib_scale10(int64_t& x, int32_t e) {
+    if (x == 0 || e == 0) {
+        return true;
+    }
+    return e <= 18 && !__builtin_mul_overflow(x, flib_pow10[e], &x);
+}
+
+// -1, 0 or 1 as a * 10^pa is less than, equal to or greater than b * 10^pb
+static inline int32_t flib_cmp10(int64_t a, int32_t pa, int64_t b, int32_t pb) {
+    int32_t sa = (a > 0) - (a < 0);
+    int32_t sb = (b > 0) - (b < 0);
+    if (sa != sb || sa == 0) {
+        return (sa > sb) - (sa < sb);
+    }
+    int32_t e = pa - pb;
+    // |a|, |b| < 10^19, so past 19 digits of difference the exponents decide
+    if (e > 19) {
+        return sa;
+    }
+    if (e < -19) {
+        return -sa;
+    }
+    int128_t x = a;
+    int128_t y = b;
+    if (e > 0) {
+        x *= flib_pow10[e > 18 ? 18 : e];
+        x *= e > 18 ? 10 : 1;
+    } else if (e < 0) {
+        y *= flib_pow10[-e > 18 ? 18 : -e];
+        y *= -e > 18 ? 10 : 1;
+    }
+    return (x > y) - (x < y);
+}
+
+// puts n / d * 10^p in lowest terms, with d > 0 and the factors of ten of n and d moved into p
+static inline void flib_normalize10(int64_t& n, int64_t& d, int32_t& p) {
+    if (d < 0) {
+        n = -n;
+        d = -d;
+    }
+    int64_t a = n < 0 ? -n : n;
+    int64_t b = d;
+    int64_t c;
+    while (a != 0) {
+        c = a;
+        a = b % a;
+        b = c;
+    }
+    n /= b;
+    d /= b;
+    if (n == 0) {
+        d = 1;
+        p = 0;
+        return;
+    }
+    p += flib_strip10(n);
+    uint64_t u = d;
+    p -= flib_strip10(u);
+    d = u;
+    // a power of ten can still cancel a lone 2 or 5 on the other side (2/15 * 10^1 = 4/3),
+    // cancel those too (while the result fits in 32 bits) so equal values are stored the same way
+    while (p > 0 && (d & 1) == 0 && n <= INT32_MAX / 5 && n >= -INT32_MAX / 5) {
+        d >>= 1;
+        n *= 5;
+        p--;
+    }
+    while (p > 0 && d % 5 == 0 && n <= INT32_MAX / 2 && n >= -INT32_MAX / 2) {
+        d /= 5;
+        n *= 2;
+        p--;
+    }
+    while (p < 0 && (n & 1) == 0 && d <= INT32_MAX / 5) {
+        n /= 2;
+        d *= 5;
+        p++;
+    }
+    while (p < 0 && n % 5 == 0 && d <= INT32_MAX / 2) {
+        n /= 5;
+        d *= 2;
+        p++;
+    }
+}
@@ -0,0 +1,412 @@
+// fsum: exact count, sum, mean, min and max of the numbers in text or csv files
+// build: g++ -O2 -std=c++17 -pthread -Isrc src/fsum.cpp -o fsum
+// usage: fsum [-t threads] [-c column] file...
+//
+// numbers are decimals (12.50, -3e-2) or fractions (3/4, 1.5/7) separated by commas, semicolons
+// or whitespace. any other field (headers, labels, dates) is skipped and counted.
+// a quoted field ("12.50") is one field even if it contains separators, and is skipped unless all of it
+// is one number, so "1,234.50" is skipped rather than read as 1 and 234.50. quoted fields end at the line end.
+// with -c only the given column (1 based, split on commas, semicolons and tabs outside quotes) is read.
+// files are memory mapped and split into chunks that end on line boundaries,
+// worker threads parse and reduce chunks into their own exact totals, which are merged at the end.
+// decimals are summed as fracd style mantissas at a common power of ten (no GCD),
+// fractions as one 128-bit fraction, so the results are exact or the tool reports an overflow.
+
+#include "flib/fracd.hpp"
+#include "flib/int128.hpp"
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHUNK_SIZE (32 << 20)
+
+// num / den with den > 0, both fit in 64 bits so cross products fit in 128
+struct ratio {
+    int64_t num;
+    int64_t den;
+};
+
+static bool less(ratio a, ratio b) {
+    if (a.den == b.den) {
+        return a.num < b.num;
+    }
+    return (int128_t)a.num * b.den < (int128_t)b.num * a.den;
+}
+
+struct total {
+    int128_t dec = 0; // sum of the decimals = dec * 10^decpow
+    int32_t decpow = 0;
+    uint64_t decs = 0;
+    int128_t fnum = 0; // sum of the fractions = fnum / fden, reduced lazily
+    int128_t fden = 1;
+    uint64_t count = 0;
+    uint64_t skipped = 0;
+    ratio min = {0, 1};
+    ratio max = {0, 1};
+    bool overflow = false;
+
+    void minmax(ratio r) {
+        if (count == 0 || less(r, min)) {
+            min = r;
+        }
+        if (count == 0 || less(max, r)) {
+            max = r;
+        }
+        count++;
+    }
+
+    void addDecimal(int128_t n, int32_t p) {
+        if (decs == 0 || dec == 0) {
+            decpow = p;
+        }
+        if (p < decpow) {
+            // finer scale than the sum so far, rescale the sum once
+            if (decpow - p > 38 || __builtin_mul_overflow(dec, flib_pow10_128(decpow - p), &dec)) {
+                overflow = true;
+                return;
+            }
+            decpow = p;
+        }
+        if (p - decpow > 38 || __builtin_mul_overflow(n, flib_pow10_128(p - decpow), &n) || __builtin_add_overflow(dec, n, &dec)) {
+            overflow = true;
+            return;
+        }
+        decs++;
+    }
+
+    void addFraction(int128_t n, int128_t d) {
+        if (d == fden) {
+            if (__builtin_add_overflow(fnum, n, &fnum)) {
+                overflow = true;
+            }
+            return;
+        }
+        int128_t g = gcd128(fden, d);
+        int128_t a, b;
+        if (__builtin_mul_overflow(fnum, d / g, &a) || __builtin_mul_overflow(n, fden / g, &b) ||
+            __builtin_add_overflow(a, b, &fnum) || __builtin_mul_overflow(fden / g, d, &fden)) {
+            overflow = true;
+            return;
+        }
+        if (fden > ((int128_t)1 << 96)) {
+            g = gcd128(fnum, fden);
+            fnum /= g;
+            fden /= g;
+        }
+    }
+
+    void add(fracd v) {
+        int64_t n = v.getNum();
+        int32_t p = v.getPower();
+        if (p < -18 || p > 18 || (p > 0 && (n > INT64_MAX / flib_pow10[p] || n < -INT64_MAX / flib_pow10[p]))) {
+            overflow = true;
+            return;
+        }
+        minmax(p < 0 ? ratio{n, flib_pow10[-p]} : ratio{n * flib_pow10[p], 1});
+        addDecimal(n, p);
+    }
+
+    void add(fracd a, fracd b) {
+        int128_t n = a.getNum();
+        int128_t d = b.getNum();
+        int32_t p = a.getPower() - b.getPower();
+        if (d == 0) {
+            printf("Warning: denominator is 0, answer is undefined.\n");
+            skipped++;
+            return;
+        }
+        if (p > 18 || p < -18) {
+            overflow = true;
+            return;
+        }
+        if (p > 0) {
+            n *= flib_pow10[p];
+        } else {
+            d *= flib_pow10[-p];
+        }
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        int128_t g = gcd128(n, d);
+        n /= g;
+        d /= g;
+        if (n > INT64_MAX || n < -INT64_MAX || d > INT64_MAX) {
+            overflow = true;
+            return;
+        }
+        minmax(ratio{(int64_t)n, (int64_t)d});
+        addFraction(n, d);
+    }
+
+    void merge(const total& t) {
+        if (t.count != 0) {
+            if (count == 0 || less(t.min, min)) {
+                min = t.min;
+            }
+            if (count == 0 || less(max, t.max)) {
+                max = t.max;
+            }
+        }
+        if (t.decs != 0) {
+            addDecimal(t.dec, t.decpow);
+            decs += t.decs - 1;
+        }
+        addFraction(t.fnum, t.fden);
+        count += t.count;
+        skipped += t.skipped;
+        overflow = overflow || t.overflow;
+    }
+
+    // exact sum as a reduced fraction, false on overflow
+    bool sum(int128_t& n, int128_t& d) {
+        int128_t a, b;
+        if (decpow >= 0) {
+            if (decpow > 38 || __builtin_mul_overflow(dec, flib_pow10_128(decpow), &a) || __builtin_mul_overflow(a, fden, &a) ||
+                __builtin_add_overflow(a, fnum, &n)) {
+                return false;
+            }
+            d = fden;
+        } else {
+            if (decpow < -38 || __builtin_mul_overflow(dec, fden, &a) || __builtin_mul_overflow(fnum, flib_pow10_128(-decpow), &b) ||
+                __builtin_add_overflow(a, b, &n) || __builtin_mul_overflow(fden, flib_pow10_128(-decpow), &d)) {
+                return false;
+            }
+        }
+        int128_t g = gcd128(n, d);
+        n /= g;
+        d /= g;
+        return true;
+    }
+};
+
+static bool separator(char c) {
+    return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '"';
+}
+
+// adds the number or fraction that is all of [c, end), anything else is skipped
+static void parseValue(const char* c, const char* end, total& t) {
+    while (c < end && (*c == ' ' || *c == '\t')) {
+        c++;
+    }
+    while (end > c && (end[-1] == ' ' || end[-1] == '\t')) {
+        end--;
+    }
+    if (c == end) {
+        return;
+    }
+    fracd a, b;
+    // a number too large for fracd is an overflow, not a skipped field
+    bool big = false;
+    const char* n = fracd::parse(c, end, a, &big);
+    if (n == end) {
+        t.add(a);
+        return;
+    }
+    if (n != NULL && *n == '/') {
+        const char* m = fracd::parse(n + 1, end, b, &big);
+        if (m == end) {
+            t.add(a, b);
+            return;
+        }
+    }
+    if (big) {
+        t.overflow = true;
+    } else {
+        t.skipped++;
+    }
+}
+
+// column < 0 reads every field
+static void parseChunk(const char* c, const char* end, int32_t column, total& t) {
+    int32_t field = 0;
+    while (c < end) {
+        if (*c == '"') {
+            // quoted field, runs to the closing quote ("" is an escaped quote) or the end of the line,
+            // separators inside it do not split it or count as columns
+            const char* q = c + 1;
+            while (q < end && *q != '\n' && (*q != '"' || (q + 1 < end && q[1] == '"'))) {
+                q += *q == '"' ? 2 : 1;
+            }
+            if (column < 0 || field == column) {
+                parseValue(c + 1, q, t);
+            }
+            c = q < end && *q == '"' ? q + 1 : q;
+            continue;
+        }
+        if (separator(*c)) {
+            if (*c == '\n') {
+                field = 0;
+            } else if (*c == ',' || *c == ';' || *c == '\t') {
+                field++;
+            }
+            c++;
+            continue;
+        }
+        const char* e = c;
+        while (e < end && !separator(*e)) {
+            e++;
+        }
+        if (column < 0 || field == column) {
+            parseValue(c, e, t);
+        }
+        c = e;
+    }
+}
+
+// prints n/d and its decimal expansion, cut off after 30 digits with "..." if it does not terminate
+static void print(const char* label, int128_t n, int128_t d) {
+    char a[48], b[48];
+    int128_t g = gcd128(n, d);
+    n /= g;
+    d /= g;
+    sprint128(a, n);
+    sprint128(b, d);
+    printf("%-8s%s/%s = ", label, a, b);
+    uint128_t un = n < 0 ? -(uint128_t)n : (uint128_t)n;
+    uint128_t ud = d;
+    sprint128(a, un / ud);
+    printf("%s%s", n < 0 ? "-" : "", a);
+    uint128_t r = un % ud;
+    if (r != 0) {
+        printf(".");
+    }
+    for (int32_t i = 0; i < 30 && r != 0; i++) {
+        if (r > (~(uint128_t)0) / 10) {
+            break;
+        }
+        r *= 10;
+        printf("%d", (int32_t)(r / ud));
+        r %= ud;
+    }
+    printf("%s\n", r != 0 ? "..." : "");
+}
+
+static bool sumFile(const char* path, int32_t threads, int32_t column, total& result) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+    const char* data = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    // chunk boundaries, each moved forward to the start of the next line
+    std::vector<size_t> bounds;
+    bounds.push_back(0);
+    for (size_t pos = CHUNK_SIZE; pos < size; pos += CHUNK_SIZE) {
+        const char* nl = (const char*)memchr(data + pos, '\n', size - pos);
+        if (nl == NULL) {
+            break;
+        }
+        pos = nl + 1 - data;
+        bounds.push_back(pos);
+    }
+    bounds.push_back(size);
+
+    size_t chunks = bounds.size() - 1;
+    if ((size_t)threads > chunks) {
+        threads = chunks;
+    }
+    std::atomic<size_t> next(0);
+    std::vector<total> totals(threads);
+    std::vector<std::thread> workers;
+    for (int32_t i = 0; i < threads; i++) {
+        workers.emplace_back([&, i]() {
+            for (size_t c = next++; c < chunks; c = next++) {
+                parseChunk(data + bounds[c], data + bounds[c + 1], column, totals[i]);
+            }
+        });
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    for (size_t i = 0; i < totals.size(); i++) {
+        result.merge(totals[i]);
+    }
+    munmap((void*)data, size);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int32_t threads = std::thread::hardware_concurrency();
+    if (threads < 1) {
+        threads = 1;
+    }
+    int32_t column = -1;
+    int32_t first = 1;
+    while (first + 1 < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-t") == 0) {
+            threads = atoi(argv[first + 1]);
+            if (threads < 1) {
+                threads = 1;
+            }
+        } else if (strcmp(argv[first], "-c") == 0) {
+            column = atoi(argv[first + 1]) - 1;
+            if (column < 0) {
+                fprintf(stderr, "error: columns start at 1\n");
+                return 2;
+            }
+        } else {
+            break;
+        }
+        first += 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [-t threads] [-c column] file...\n", argv[0]);
+        return 2;
+    }
+
+    total t;
+    for (int32_t i = first; i < argc; i++) {
+        if (!sumFile(argv[i], threads, column, t)) {
+            return 1;
+        }
+    }
+
+    int128_t n, d;
+    if (t.overflow || !t.sum(n, d)) {
+        fprintf(stderr, "error: a number or the result is out of range, no exact answer\n");
+        return 1;
+    }
+    printf("%-8s%llu\n", "count", (unsigned long long)t.count);
+    printf("%-8s%llu\n", "skipped", (unsigned long long)t.skipped);
+    if (t.count == 0) {
+        return 0;
+    }
+    print("sum", n, d);
+    int128_t md;
+    int128_t g = gcd128(n, t.count);
+    if (__builtin_mul_overflow(d, (int128_t)(t.count / g), &md)) {
+        fprintf(stderr, "error: mean does not fit in 128 bits\n");
+    } else {
+        print("mean", n / g, md);
+    }
+    print("min", t.min.num, t.min.den);
+    print("max", t.max.num, t.max.den);
+    return 0;
+}
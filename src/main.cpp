@@ -4,6 +4,7 @@
 int main(void) {
     // fracti can be replaced with fract or frac and the answers will be identical
     // The internal workings are different, and some are faster and slower, and some will not work with bigger numbers.
+    // fraca (flib/fraca.hpp) widens itself to 64 or 128 bits when a result gets too big, so it does not have this problem.
     fracti a(20000, 300);
     fracti b(10000, 200);
     fracti c = a * b;